@@ -0,0 +1,20 @@
+#!/bin/bash
+# Build script for benchmarks
+# The timings only mean something against an engine built with optimizations, add -O2 to its compilerFlags.
+set echo on
+
+mkdir -p ../bin
+
+# Get a list of all the .c files.
+cFilenames=$(find . -type f -name "*.c")
+
+# echo "Files : " $cFilenames
+
+assembly="benchmarks"
+compilerFlags="-g -O2 -fdeclspec -fPIC"
+includeFlags="-Isrc -I../engine/src"
+linkerFlags="-L../bin/ -L$VULKAN_SDK/lib -lengine -Wl,-rpath,."
+defines="-DAIMPORT"
+
+echo "Building $assembly..."
+clang $cFilenames $compilerFlags -o ../bin/$assembly $defines $includeFlags $linkerFlags
\ No newline at end of file
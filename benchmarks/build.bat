@@ -0,0 +1,22 @@
+REM Build script for benchmarks
+REM The timings only mean something against an engine built with optimizations, add -O2 to its compilerFlags.
+@ECHO OFF
+SetLocal EnableDelayedExpansion
+
+REM Get a list of all the .c files
+SET cFilenames=
+FOR /R %%f in (*.c) do (
+    SET cFilenames=!cFilenames! %%f
+)
+
+REM echo "Files:" %cFilenames%
+
+SET assembly=benchmarks
+SET compilerFlags=-g -O2
+SET includeFlags=-Isrc -I../engine/src/
+SET linkerFlags=-L../bin/ -lengine.lib
+SET defines=-DAIMPORT
+SET extension=exe
+
+ECHO "Building %assembly%% ..."
+clang %cFilenames% %compilerFlags% -o ../bin/%assembly%.%extension% %defines% %includeFlags% %linkerFlags%
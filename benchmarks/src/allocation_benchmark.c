@@ -0,0 +1,62 @@
+#include "benchmark.h"
+
+#include <core/amemory.h>
+
+typedef enum allocation_path
+{
+    // What aallocate did before it went through calloc: allocate, then clear by hand.
+    ALLOCATION_PATH_CLEARED,
+    ALLOCATION_PATH_ZEROED,
+    ALLOCATION_PATH_UNINIT,
+    ALLOCATION_PATH_MAX
+} allocation_path;
+
+// The seconds taken to allocate a block, fill it once and free it.
+static f64 time_allocation(u64 size, allocation_path path)
+{
+    f64 best = 0;
+    for (u32 run = 0; run < BENCHMARK_RUNS; ++run)
+    {
+        clock timer;
+        clock_start(&timer);
+        u8* block;
+        if (path == ALLOCATION_PATH_CLEARED)
+        {
+            block = aallocate_uninit(size, MEMORY_TAG_ARRAY);
+            azero_memory(block, size);
+        }
+        else if (path == ALLOCATION_PATH_ZEROED)
+        {
+            block = aallocate(size, MEMORY_TAG_ARRAY);
+        }
+        else
+        {
+            block = aallocate_uninit(size, MEMORY_TAG_ARRAY);
+        }
+        aset_memory(block, 1, size);
+        benchmark_consume(block[size / 2]);
+        afree(block, size, MEMORY_TAG_ARRAY);
+        f64 elapsed = benchmark_elapsed(&timer);
+
+        if (run == 0 || elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+void allocation_benchmark()
+{
+    // aallocate zeroes through calloc, which skips the clear when the pages come fresh from the
+    // OS; aallocate_uninit doesn't clear at all. Both should beat clearing by hand.
+    AINFO("Allocate, fill once and free:");
+    for (u64 size = 64 * 1024; size <= 64 * 1024 * 1024; size *= 4)
+    {
+        f64 cleared = time_allocation(size, ALLOCATION_PATH_CLEARED);
+        f64 zeroed = time_allocation(size, ALLOCATION_PATH_ZEROED);
+        f64 uninit = time_allocation(size, ALLOCATION_PATH_UNINIT);
+        AINFO("  %6lluKiB uninit+zero %9.1fus, aallocate %9.1fus, aallocate_uninit %9.1fus",
+              size / 1024, cleared * 1e6, zeroed * 1e6, uninit * 1e6);
+    }
+}
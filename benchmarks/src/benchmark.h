@@ -0,0 +1,45 @@
+#pragma once
+
+#include <defines.h>
+#include <core/clock.h>
+#include <core/logger.h>
+
+// Each benchmark times the engine at the sizes a tuned default was chosen from, and logs its
+// measurements so the default can be checked again on other hardware.
+
+typedef void (*PFN_benchmark)();
+
+// The number of times each measurement is repeated, keeping the fastest run.
+#define BENCHMARK_RUNS 5
+
+// The seconds elapsed since a clock was started.
+static inline f64 benchmark_elapsed(clock* timer)
+{
+    clock_update(timer);
+    return timer->elapsed;
+}
+
+// A xorshift generator, seeded the same on every run so the inputs are reproducible.
+static inline u64 benchmark_random()
+{
+    static u64 state = 88172645463325252ULL;
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Keep the compiler from discarding a computed result.
+static inline void benchmark_consume(u64 value)
+{
+    static volatile u64 sink;
+    sink += value;
+}
+
+void allocation_benchmark();
+void darray_access_benchmark();
+void darray_growth_benchmark();
+void memory_copy_benchmark();
+void priority_queue_benchmark();
+void ring_queue_benchmark();
+void sort_benchmark();
@@ -0,0 +1,59 @@
+#include "benchmark_thread.h"
+
+#if APLATFORM_WINDOWS
+#include <windows.h>
+
+static DWORD WINAPI thread_entry(LPVOID parameter)
+{
+    benchmark_thread* thread = parameter;
+    thread->run(thread->argument);
+    return 0;
+}
+
+void benchmark_thread_start(benchmark_thread* thread, PFN_thread run, u64 argument)
+{
+    thread->run = run;
+    thread->argument = argument;
+    thread->handle = (u64)CreateThread(0, 0, thread_entry, thread, 0, 0);
+}
+
+void benchmark_thread_join(benchmark_thread* thread)
+{
+    WaitForSingleObject((HANDLE)thread->handle, INFINITE);
+    CloseHandle((HANDLE)thread->handle);
+}
+
+void benchmark_thread_yield()
+{
+    SwitchToThread();
+}
+#else
+#include <pthread.h>
+#include <sched.h>
+
+static void* thread_entry(void* parameter)
+{
+    benchmark_thread* thread = parameter;
+    thread->run(thread->argument);
+    return 0;
+}
+
+void benchmark_thread_start(benchmark_thread* thread, PFN_thread run, u64 argument)
+{
+    thread->run = run;
+    thread->argument = argument;
+    pthread_t handle;
+    pthread_create(&handle, 0, thread_entry, thread);
+    thread->handle = (u64)handle;
+}
+
+void benchmark_thread_join(benchmark_thread* thread)
+{
+    pthread_join((pthread_t)thread->handle, 0);
+}
+
+void benchmark_thread_yield()
+{
+    sched_yield();
+}
+#endif
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <defines.h>
+
+// Threads for the benchmarks, over pthreads or the Win32 API. Kept out of benchmark.h: the OS
+// thread headers declare a clock() that collides with the engine's clock type.
+
+typedef void (*PFN_thread)(u64 argument);
+
+typedef struct benchmark_thread
+{
+    // The pthread_t or HANDLE of the thread.
+    u64 handle;
+    PFN_thread run;
+    u64 argument;
+} benchmark_thread;
+
+// Run a function on a new thread. The thread struct must live until it is joined.
+void benchmark_thread_start(benchmark_thread* thread, PFN_thread run, u64 argument);
+void benchmark_thread_join(benchmark_thread* thread);
+// Give the CPU away, for threads waiting on each other.
+void benchmark_thread_yield();
@@ -0,0 +1,114 @@
+#include "benchmark.h"
+
+#include <core/amemory.h>
+#include <core/containers/darray.h>
+
+typedef enum access_loop
+{
+    // Calls the exported getter every iteration, as darray_length did before it was inlined.
+    ACCESS_LOOP_EXPORTED_LENGTH,
+    ACCESS_LOOP_INLINE_LENGTH,
+    ACCESS_LOOP_FOR_EACH,
+    ACCESS_LOOP_FOR_EACH_INDEX,
+    ACCESS_LOOP_MAX
+} access_loop;
+
+static const char* loop_names[ACCESS_LOOP_MAX] = {
+    "_darray_field_get in condition",
+    "darray_length in condition",
+    "darray_for_each",
+    "darray_for_each_index"};
+
+static u64 sum_elements(u32* array, access_loop loop)
+{
+    u64 sum = 0;
+    switch (loop)
+    {
+        case ACCESS_LOOP_EXPORTED_LENGTH:
+            for (u64 i = 0; i < _darray_field_get(array, DARRAY_LENGTH); ++i)
+            {
+                sum += array[i];
+            }
+            break;
+        case ACCESS_LOOP_INLINE_LENGTH:
+            for (u64 i = 0; i < darray_length(array); ++i)
+            {
+                sum += array[i];
+            }
+            break;
+        case ACCESS_LOOP_FOR_EACH:
+            darray_for_each(u32, element, array)
+            {
+                sum += *element;
+            }
+            break;
+        default:
+            darray_for_each_index(i, array)
+            {
+                sum += array[i];
+            }
+            break;
+    }
+    return sum;
+}
+
+void darray_access_benchmark()
+{
+    const u64 count = 10000000;
+    u32* array = darray_reserve(u32, count);
+    for (u64 i = 0; i < count; ++i)
+    {
+        darray_push(array, (u32)i);
+    }
+
+    AINFO("Iterate %llu u32:", count);
+    for (u32 loop = 0; loop < ACCESS_LOOP_MAX; ++loop)
+    {
+        f64 best = 0;
+        for (u32 run = 0; run < BENCHMARK_RUNS; ++run)
+        {
+            clock timer;
+            clock_start(&timer);
+            benchmark_consume(sum_elements(array, loop));
+            f64 elapsed = benchmark_elapsed(&timer);
+            if (run == 0 || elapsed < best)
+            {
+                best = elapsed;
+            }
+        }
+        AINFO("  %-32s %7.2fms", loop_names[loop], best * 1e3);
+    }
+
+    // darray_push appends in place while there is room; _darray_push always calls into the engine.
+    AINFO("Push %llu u32 into a warm array:", count);
+    for (u32 inlined = 0; inlined < 2; ++inlined)
+    {
+        f64 best = 0;
+        for (u32 run = 0; run < BENCHMARK_RUNS; ++run)
+        {
+            darray_clear(array);
+            clock timer;
+            clock_start(&timer);
+            for (u64 i = 0; i < count; ++i)
+            {
+                u32 value = (u32)i;
+                if (inlined)
+                {
+                    darray_push(array, value);
+                }
+                else
+                {
+                    array = _darray_push(array, &value);
+                }
+            }
+            f64 elapsed = benchmark_elapsed(&timer);
+            if (run == 0 || elapsed < best)
+            {
+                best = elapsed;
+            }
+        }
+        AINFO("  %-32s %7.2fms", inlined ? "darray_push" : "_darray_push", best * 1e3);
+    }
+
+    darray_destroy(array);
+}
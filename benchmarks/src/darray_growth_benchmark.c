@@ -0,0 +1,92 @@
+#include "benchmark.h"
+
+#include <core/amemory.h>
+#include <core/containers/darray.h>
+
+typedef struct element64
+{
+    u64 fields[8];
+} element64;
+
+static const char* policy_names[] = {"2x", "1.5x"};
+
+// Push count u32s into a fresh array, logging the time taken, the number of reallocations and
+// the capacity left unused.
+static void benchmark_push_u32(u64 count, b8 reserve)
+{
+    f64 best = 0;
+    u64 growth_count = 0;
+    u64 capacity = 0;
+    for (u32 run = 0; run < BENCHMARK_RUNS; ++run)
+    {
+        clock timer;
+        clock_start(&timer);
+        u32* array = reserve ? darray_reserve(u32, count) : darray_create(u32);
+        growth_count = 0;
+        for (u64 i = 0; i < count; ++i)
+        {
+            u64 old_capacity = darray_capacity(array);
+            darray_push(array, (u32)i);
+            growth_count += darray_capacity(array) != old_capacity;
+        }
+        f64 elapsed = benchmark_elapsed(&timer);
+        capacity = darray_capacity(array);
+        benchmark_consume(array[count - 1]);
+        darray_destroy(array);
+
+        if (run == 0 || elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+
+    AINFO("    %-8s %10.1fus, %3llu reallocations, %5.1f%% unused", reserve ? "reserved" : "pushed", best * 1e6, growth_count, 100.0 * (f64)(capacity - count) / (f64)capacity);
+}
+
+static void benchmark_push_element64(u64 count)
+{
+    f64 best = 0;
+    u64 capacity = 0;
+    for (u32 run = 0; run < BENCHMARK_RUNS; ++run)
+    {
+        clock timer;
+        clock_start(&timer);
+        element64* array = darray_create(element64);
+        element64 element = {0};
+        for (u64 i = 0; i < count; ++i)
+        {
+            element.fields[0] = i;
+            darray_push(array, element);
+        }
+        f64 elapsed = benchmark_elapsed(&timer);
+        capacity = darray_capacity(array);
+        benchmark_consume(array[count - 1].fields[0]);
+        darray_destroy(array);
+
+        if (run == 0 || elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+
+    AINFO("  %llu 64-byte structs pushed %10.1fus, %5.1f%% unused", count, best * 1e6, 100.0 * (f64)(capacity - count) / (f64)capacity);
+}
+
+void darray_growth_benchmark()
+{
+    // DARRAY_GROWTH_DOUBLE is the default: it reallocates less often than 1.5x, while growth in
+    // place and remapping keep the copies of either policy cheap. "reserved" is the lower bound.
+    for (u32 policy = DARRAY_GROWTH_DOUBLE; policy <= DARRAY_GROWTH_ONE_AND_A_HALF; ++policy)
+    {
+        darray_set_growth_policy(policy);
+        AINFO("Growth policy %s:", policy_names[policy]);
+        for (u64 count = 1000; count <= 10000000; count *= 100)
+        {
+            AINFO("  %llu u32:", count);
+            benchmark_push_u32(count, FALSE);
+            benchmark_push_u32(count, TRUE);
+        }
+        benchmark_push_element64(1000000);
+    }
+    darray_set_growth_policy(DARRAY_GROWTH_DOUBLE);
+}
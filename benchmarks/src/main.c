@@ -0,0 +1,51 @@
+#include "benchmark.h"
+
+#include <core/amemory.h>
+#include <core/astring.h>
+
+typedef struct benchmark_entry
+{
+    const char* name;
+    PFN_benchmark run;
+} benchmark_entry;
+
+static const benchmark_entry benchmarks[] = {
+    {"allocation", allocation_benchmark},
+    {"darray_access", darray_access_benchmark},
+    {"darray_growth", darray_growth_benchmark},
+    {"memory_copy", memory_copy_benchmark},
+    {"priority_queue", priority_queue_benchmark},
+    {"ring_queue", ring_queue_benchmark},
+    {"sort", sort_benchmark},
+};
+
+/**
+ * Run the benchmarks named on the command line, or all of them.
+ */
+int main(int argc, char** argv)
+{
+    if (!initialize_memory(0, 0))
+    {
+        AFATAL("Failed to initialize the memory subsystem!");
+        return -1;
+    }
+
+    u32 count = sizeof(benchmarks) / sizeof(benchmarks[0]);
+    for (u32 i = 0; i < count; ++i)
+    {
+        b8 selected = argc < 2;
+        for (i32 arg = 1; arg < argc; ++arg)
+        {
+            selected |= strings_equal(argv[arg], benchmarks[i].name);
+        }
+
+        if (selected)
+        {
+            AINFO("Running the %s benchmark...", benchmarks[i].name);
+            benchmarks[i].run();
+        }
+    }
+
+    shutdown_memory();
+    return 0;
+}
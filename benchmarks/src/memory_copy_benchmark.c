@@ -0,0 +1,66 @@
+#include "benchmark.h"
+
+#include <core/amemory.h>
+#include <core/memory/simd_memory.h>
+
+#include <string.h>
+
+typedef void* (*PFN_copy)(void* dest, const void* source, u64 size);
+
+static void* libc_copy(void* dest, const void* source, u64 size)
+{
+    return memcpy(dest, source, size);
+}
+
+// The throughput of a copy function, in GB/s, copying about 1GB in blocks of the given size.
+static f64 copy_throughput(PFN_copy copy, u8* dest, const u8* source, u64 size)
+{
+    u64 iterations = (1024ULL * 1024 * 1024) / size;
+    if (iterations == 0)
+    {
+        iterations = 1;
+    }
+
+    f64 best = 0;
+    for (u32 run = 0; run < BENCHMARK_RUNS; ++run)
+    {
+        clock timer;
+        clock_start(&timer);
+        for (u64 i = 0; i < iterations; ++i)
+        {
+            copy(dest, source, size);
+        }
+        benchmark_consume(dest[size - 1]);
+        f64 elapsed = benchmark_elapsed(&timer);
+
+        if (run == 0 || elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+    return (f64)(size * iterations) / best * 1e-9;
+}
+
+void memory_copy_benchmark()
+{
+    // acopy_memory takes the non-temporal path from SIMD_MEMORY_STREAMING_THRESHOLD, which should
+    // be the first size where it beats libc. acopy_memory_streaming takes it from
+    // SIMD_MEMORY_STREAMING_MIN_SIZE.
+    const u64 max_size = 64 * 1024 * 1024;
+    u8* source = aallocate(max_size, MEMORY_TAG_ARRAY);
+    u8* dest = aallocate(max_size, MEMORY_TAG_ARRAY);
+    aset_memory(source, 1, max_size);
+
+    AINFO("Copy throughput in GB/s, streaming path %s, threshold %lluKiB:",
+          simd_memory_path_name(), (u64)SIMD_MEMORY_STREAMING_THRESHOLD / 1024);
+    for (u64 size = 64; size <= max_size; size *= 4)
+    {
+        f64 libc = copy_throughput(libc_copy, dest, source, size);
+        f64 engine = copy_throughput(acopy_memory, dest, source, size);
+        f64 streaming = copy_throughput(acopy_memory_streaming, dest, source, size);
+        AINFO("  %9lluB libc %6.1f, acopy_memory %6.1f, acopy_memory_streaming %6.1f", size, libc, engine, streaming);
+    }
+
+    afree(dest, max_size, MEMORY_TAG_ARRAY);
+    afree(source, max_size, MEMORY_TAG_ARRAY);
+}
@@ -0,0 +1,203 @@
+#include "benchmark.h"
+
+#include <core/amemory.h>
+#include <core/containers/priority_queue.h>
+
+typedef enum priority_order
+{
+    PRIORITY_ORDER_RANDOM,
+    PRIORITY_ORDER_ASCENDING,
+    PRIORITY_ORDER_DESCENDING,
+    PRIORITY_ORDER_MAX
+} priority_order;
+
+static const char* order_names[PRIORITY_ORDER_MAX] = {"random", "ascending", "descending"};
+
+static void fill_priorities(f64* priorities, u64* values, u64 count, priority_order order)
+{
+    for (u64 i = 0; i < count; ++i)
+    {
+        switch (order)
+        {
+            case PRIORITY_ORDER_RANDOM:
+                priorities[i] = (f64)(benchmark_random() % 1000000000);
+                break;
+            case PRIORITY_ORDER_ASCENDING:
+                priorities[i] = (f64)i;
+                break;
+            default:
+                priorities[i] = (f64)(count - i);
+                break;
+        }
+        values[i] = i;
+    }
+}
+
+// The seconds taken to push count entries into a queue already holding queued_count, one by one
+// or with a single priority_queue_push_many.
+static f64 time_pushes(const f64* priorities, const u64* values, u64 queued_count, u64 count, b8 many)
+{
+    f64 best = 0;
+    for (u32 run = 0; run < BENCHMARK_RUNS; ++run)
+    {
+        priority_queue queue;
+        priority_queue_create(queued_count + count, MEMORY_TAG_JOB, &queue);
+        for (u64 i = 0; i < queued_count; ++i)
+        {
+            priority_queue_push(&queue, priorities[i], values[i]);
+        }
+
+        clock timer;
+        clock_start(&timer);
+        if (many)
+        {
+            priority_queue_push_many(&queue, priorities + queued_count, values + queued_count, count, 0);
+        }
+        else
+        {
+            for (u64 i = queued_count; i < queued_count + count; ++i)
+            {
+                priority_queue_push(&queue, priorities[i], values[i]);
+            }
+        }
+        f64 elapsed = benchmark_elapsed(&timer);
+
+        priority_queue_destroy(&queue);
+        if (run == 0 || elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+// Index of the first entry of a descending array at or below a priority.
+static u64 sorted_array_find(const f64* array, u64 count, f64 priority)
+{
+    u64 low = 0;
+    u64 high = count;
+    while (low < high)
+    {
+        u64 middle = (low + high) / 2;
+        if (array[middle] > priority)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+static void sorted_array_insert(f64* array, u64* count, f64 priority)
+{
+    u64 index = sorted_array_find(array, *count, priority);
+    amove_memory(array + index + 1, array + index, (*count - index) * sizeof(f64));
+    array[index] = priority;
+    (*count)++;
+}
+
+static void sorted_array_erase(f64* array, u64* count, f64 priority)
+{
+    u64 index = sorted_array_find(array, *count, priority);
+    amove_memory(array + index, array + index + 1, (*count - index - 1) * sizeof(f64));
+    (*count)--;
+}
+
+// N pushes, N/2 decrease-keys and N pops, on the heap and on an array kept sorted in descending
+// order, the lowest priority last.
+static void benchmark_against_sorted_array(u64 count)
+{
+    f64* priorities = aallocate(count * sizeof(f64), MEMORY_TAG_ARRAY);
+    u64* values = aallocate(count * sizeof(u64), MEMORY_TAG_ARRAY);
+    fill_priorities(priorities, values, count, PRIORITY_ORDER_RANDOM);
+    priority_queue_handle* handles = aallocate(count * sizeof(priority_queue_handle), MEMORY_TAG_ARRAY);
+    f64* array = aallocate(count * sizeof(f64), MEMORY_TAG_ARRAY);
+
+    priority_queue queue;
+    priority_queue_create(count, MEMORY_TAG_JOB, &queue);
+    clock timer;
+    clock_start(&timer);
+    for (u64 i = 0; i < count; ++i)
+    {
+        handles[i] = priority_queue_push(&queue, priorities[i], values[i]);
+    }
+    for (u64 i = 0; i < count; i += 2)
+    {
+        priority_queue_update(&queue, handles[i], priorities[i] * 0.5);
+    }
+    f64 popped;
+    while (priority_queue_pop(&queue, &popped, 0))
+    {
+        benchmark_consume((u64)popped);
+    }
+    f64 heap_time = benchmark_elapsed(&timer);
+    priority_queue_destroy(&queue);
+
+    u64 array_count = 0;
+    clock_start(&timer);
+    for (u64 i = 0; i < count; ++i)
+    {
+        sorted_array_insert(array, &array_count, priorities[i]);
+    }
+    for (u64 i = 0; i < count; i += 2)
+    {
+        sorted_array_erase(array, &array_count, priorities[i]);
+        sorted_array_insert(array, &array_count, priorities[i] * 0.5);
+    }
+    while (array_count)
+    {
+        benchmark_consume((u64)array[--array_count]);
+    }
+    f64 array_time = benchmark_elapsed(&timer);
+
+    u64 operations = count * 5 / 2;
+    AINFO("  N=%-8llu heap %7.1fns/op, sorted array %7.1fns/op", count, heap_time * 1e9 / operations, array_time * 1e9 / operations);
+
+    afree(array, count * sizeof(f64), MEMORY_TAG_ARRAY);
+    afree(handles, count * sizeof(priority_queue_handle), MEMORY_TAG_ARRAY);
+    afree(values, count * sizeof(u64), MEMORY_TAG_ARRAY);
+    afree(priorities, count * sizeof(f64), MEMORY_TAG_ARRAY);
+}
+
+void priority_queue_benchmark()
+{
+    AINFO("Heap against a sorted array, random priorities:");
+    for (u64 count = 1000; count <= 100000; count *= 10)
+    {
+        benchmark_against_sorted_array(count);
+    }
+
+    // priority_queue_push_many heapifies when it adds at least PRIORITY_QUEUE_HEAPIFY_RATIO times
+    // as many entries as are queued, and sifts each one up otherwise. "heapify" is the cost per
+    // added entry of heapifying the queued and added entries together, "sift up" of pushing the
+    // added ones one by one; push_many should follow the faster of the two.
+    const u64 added_count = 100000;
+    const u64 ratios[] = {64, 16, 4, 1};
+    const u64 inverse_ratios[] = {4, 16};
+    u64 max_total = added_count + added_count * 16;
+    f64* priorities = aallocate(max_total * sizeof(f64), MEMORY_TAG_ARRAY);
+    u64* values = aallocate(max_total * sizeof(u64), MEMORY_TAG_ARRAY);
+
+    for (u32 order = 0; order < PRIORITY_ORDER_MAX; ++order)
+    {
+        AINFO("push_many of %llu entries, %s priorities:", added_count, order_names[order]);
+        for (u32 i = 0; i < 6; ++i)
+        {
+            u64 queued_count = i < 4 ? added_count / ratios[i] : added_count * inverse_ratios[i - 4];
+            u64 total = queued_count + added_count;
+            fill_priorities(priorities, values, total, order);
+
+            f64 heapify = time_pushes(priorities, values, 0, total, TRUE);
+            f64 sift_up = time_pushes(priorities, values, queued_count, added_count, FALSE);
+            f64 many = time_pushes(priorities, values, queued_count, added_count, TRUE);
+            AINFO("  queued %-8llu heapify %7.1fns, sift up %7.1fns, push_many %7.1fns",
+                  queued_count, heapify * 1e9 / added_count, sift_up * 1e9 / added_count, many * 1e9 / added_count);
+        }
+    }
+
+    afree(values, max_total * sizeof(u64), MEMORY_TAG_ARRAY);
+    afree(priorities, max_total * sizeof(f64), MEMORY_TAG_ARRAY);
+}
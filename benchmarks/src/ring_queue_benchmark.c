@@ -0,0 +1,162 @@
+#include "benchmark.h"
+#include "benchmark_thread.h"
+
+#include <core/containers/ring_queue.h>
+
+#define RING_QUEUE_CAPACITY 1024
+#define RING_QUEUE_OPERATIONS 4000000ULL
+#define RING_QUEUE_MAX_THREADS 16
+
+// Producers tag their elements with their index in the high bits, and the sequence number in
+// the low ones, for consumers to check each producer's elements arrive in order.
+#define PRODUCER_SHIFT 40
+#define SEQUENCE_MASK ((1ULL << PRODUCER_SHIFT) - 1)
+
+static ring_queue_spsc spsc_queue;
+static ring_queue_mpmc mpmc_queue;
+static u64 producer_count;
+static u64 per_producer_count;
+static u64 consumed_count;
+static u64 consumed_sum;
+static u64 order_errors;
+
+static void spsc_produce(u64 argument)
+{
+    for (u64 i = 0; i < RING_QUEUE_OPERATIONS; ++i)
+    {
+        while (!ring_queue_spsc_push(&spsc_queue, &i))
+        {
+            benchmark_thread_yield();
+        }
+    }
+}
+
+static void spsc_consume(u64 argument)
+{
+    for (u64 i = 0; i < RING_QUEUE_OPERATIONS; ++i)
+    {
+        u64 value;
+        while (!ring_queue_spsc_pop(&spsc_queue, &value))
+        {
+            benchmark_thread_yield();
+        }
+        if (value != i)
+        {
+            __atomic_fetch_add(&order_errors, 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void mpmc_produce(u64 producer)
+{
+    for (u64 i = 0; i < per_producer_count; ++i)
+    {
+        u64 value = (producer << PRODUCER_SHIFT) | i;
+        while (!ring_queue_mpmc_push(&mpmc_queue, &value))
+        {
+            benchmark_thread_yield();
+        }
+    }
+}
+
+static void mpmc_consume(u64 argument)
+{
+    u64 last[RING_QUEUE_MAX_THREADS];
+    for (u32 i = 0; i < RING_QUEUE_MAX_THREADS; ++i)
+    {
+        last[i] = SEQUENCE_MASK;
+    }
+
+    // The shared count is only updated when the queue runs dry, to keep it off the fast path.
+    u64 total = producer_count * per_producer_count;
+    u64 sum = 0;
+    u64 count = 0;
+    for (;;)
+    {
+        u64 value;
+        if (!ring_queue_mpmc_pop(&mpmc_queue, &value))
+        {
+            u64 consumed = __atomic_add_fetch(&consumed_count, count, __ATOMIC_RELAXED);
+            count = 0;
+            if (consumed >= total)
+            {
+                break;
+            }
+            benchmark_thread_yield();
+            continue;
+        }
+
+        u64 producer = value >> PRODUCER_SHIFT;
+        u64 sequence = value & SEQUENCE_MASK;
+        if (last[producer] != SEQUENCE_MASK && sequence <= last[producer])
+        {
+            __atomic_fetch_add(&order_errors, 1, __ATOMIC_RELAXED);
+        }
+        last[producer] = sequence;
+        sum += sequence;
+        count++;
+    }
+    __atomic_fetch_add(&consumed_sum, sum, __ATOMIC_RELAXED);
+}
+
+static void benchmark_spsc()
+{
+    ring_queue_spsc_create(sizeof(u64), RING_QUEUE_CAPACITY, &spsc_queue);
+    order_errors = 0;
+
+    benchmark_thread threads[2];
+    clock timer;
+    clock_start(&timer);
+    benchmark_thread_start(&threads[0], spsc_produce, 0);
+    benchmark_thread_start(&threads[1], spsc_consume, 0);
+    benchmark_thread_join(&threads[0]);
+    benchmark_thread_join(&threads[1]);
+    f64 elapsed = benchmark_elapsed(&timer);
+
+    AINFO("  spsc 1p/1c %6.1f Mops/s%s", RING_QUEUE_OPERATIONS / elapsed * 1e-6, order_errors ? ", OUT OF ORDER" : "");
+    ring_queue_spsc_destroy(&spsc_queue);
+}
+
+static void benchmark_mpmc(u64 producers, u64 consumers)
+{
+    ring_queue_mpmc_create(sizeof(u64), RING_QUEUE_CAPACITY, &mpmc_queue);
+    producer_count = producers;
+    per_producer_count = RING_QUEUE_OPERATIONS / producers;
+    consumed_count = 0;
+    consumed_sum = 0;
+    order_errors = 0;
+
+    benchmark_thread threads[RING_QUEUE_MAX_THREADS];
+    u64 thread_count = producers + consumers;
+    clock timer;
+    clock_start(&timer);
+    for (u64 i = 0; i < thread_count; ++i)
+    {
+        benchmark_thread_start(&threads[i], i < producers ? mpmc_produce : mpmc_consume, i);
+    }
+    for (u64 i = 0; i < thread_count; ++i)
+    {
+        benchmark_thread_join(&threads[i]);
+    }
+    f64 elapsed = benchmark_elapsed(&timer);
+
+    u64 expected_sum = producers * (per_producer_count * (per_producer_count - 1) / 2);
+    AINFO("  mpmc %llup/%lluc %6.1f Mops/s%s%s", producers, consumers,
+          (f64)(producers * per_producer_count) / elapsed * 1e-6,
+          order_errors ? ", OUT OF ORDER" : "",
+          consumed_sum != expected_sum ? ", CHECKSUM MISMATCH" : "");
+    ring_queue_mpmc_destroy(&mpmc_queue);
+}
+
+void ring_queue_benchmark()
+{
+    // Elements are u64s through a queue of RING_QUEUE_CAPACITY. Consumers check that each
+    // producer's elements arrive in order and that none is lost. On fewer cores than threads,
+    // the numbers show the overhead under time-slicing rather than parallel scaling.
+    AINFO("Ring queues, %llu u64 elements:", RING_QUEUE_OPERATIONS);
+    benchmark_spsc();
+    for (u64 producers = 1; producers <= RING_QUEUE_MAX_THREADS / 2; producers *= 2)
+    {
+        benchmark_mpmc(producers, producers);
+    }
+}
@@ -0,0 +1,120 @@
+#include "benchmark.h"
+
+#include <core/amemory.h>
+#include <core/containers/sort.h>
+
+#include <stdlib.h>
+
+typedef enum key_distribution
+{
+    KEY_DISTRIBUTION_RANDOM,
+    KEY_DISTRIBUTION_FEW_DISTINCT,
+    KEY_DISTRIBUTION_SORTED,
+    KEY_DISTRIBUTION_MAX
+} key_distribution;
+
+static const char* distribution_names[KEY_DISTRIBUTION_MAX] = {"random", "100 distinct", "sorted"};
+
+typedef enum sort_algorithm
+{
+    SORT_ALGORITHM_QSORT,
+    SORT_ALGORITHM_INTROSORT,
+    SORT_ALGORITHM_RADIX,
+    SORT_ALGORITHM_MAX
+} sort_algorithm;
+
+static i32 compare_u64(const void* a, const void* b)
+{
+    u64 left = *(const u64*)a;
+    u64 right = *(const u64*)b;
+    return (left > right) - (left < right);
+}
+
+static int qsort_compare_u64(const void* a, const void* b)
+{
+    return compare_u64(a, b);
+}
+
+// The seconds taken to sort the keys, copied to work, batch_count times in blocks of count.
+static f64 time_sort(const u64* keys, u64* work, u64* scratch, u64 count, u64 batch_count, sort_algorithm algorithm)
+{
+    f64 best = 0;
+    for (u32 run = 0; run < BENCHMARK_RUNS; ++run)
+    {
+        acopy_memory(work, keys, count * batch_count * sizeof(u64));
+        clock timer;
+        clock_start(&timer);
+        for (u64 batch = 0; batch < batch_count; ++batch)
+        {
+            u64* block = work + batch * count;
+            if (algorithm == SORT_ALGORITHM_QSORT)
+            {
+                qsort(block, count, sizeof(u64), qsort_compare_u64);
+            }
+            else if (algorithm == SORT_ALGORITHM_INTROSORT)
+            {
+                sort_elements(block, count, sizeof(u64), compare_u64);
+            }
+            else
+            {
+                sort_radix_u64(block, count, scratch);
+            }
+        }
+        f64 elapsed = benchmark_elapsed(&timer);
+        benchmark_consume(work[count - 1]);
+
+        if (run == 0 || elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+void sort_benchmark()
+{
+    // sort_elements finishes ranges below SORT_INSERTION_THRESHOLD with an insertion sort, and
+    // the radix sorts take one below SORT_RADIX_MIN_COUNT rather than pay for their histograms.
+    // Each size sorts 1M keys in total, in blocks of that size. Rebuild the engine with
+    // -DSORT_INSERTION_THRESHOLD=n or -DSORT_RADIX_MIN_COUNT=n to compare thresholds.
+    const u64 total_count = 1024 * 1024;
+    u64* keys = aallocate_uninit(total_count * sizeof(u64), MEMORY_TAG_ARRAY);
+    u64* work = aallocate_uninit(total_count * sizeof(u64), MEMORY_TAG_ARRAY);
+    u64* scratch = aallocate_uninit(total_count * sizeof(u64), MEMORY_TAG_ARRAY);
+
+    for (u32 distribution = 0; distribution < KEY_DISTRIBUTION_MAX; ++distribution)
+    {
+        AINFO("Sort %llu u64 keys, %s, in ns per key:", total_count, distribution_names[distribution]);
+        for (u64 count = 8; count <= total_count; count *= 4)
+        {
+            u64 batch_count = total_count / count;
+            for (u64 i = 0; i < count * batch_count; ++i)
+            {
+                switch (distribution)
+                {
+                    case KEY_DISTRIBUTION_RANDOM:
+                        keys[i] = benchmark_random();
+                        break;
+                    case KEY_DISTRIBUTION_FEW_DISTINCT:
+                        keys[i] = benchmark_random() % 100;
+                        break;
+                    default:
+                        keys[i] = i % count;
+                        break;
+                }
+            }
+
+            f64 times[SORT_ALGORITHM_MAX];
+            for (u32 algorithm = 0; algorithm < SORT_ALGORITHM_MAX; ++algorithm)
+            {
+                times[algorithm] = time_sort(keys, work, scratch, count, batch_count, algorithm) * 1e9 / (f64)(count * batch_count);
+            }
+            AINFO("  blocks of %-8llu qsort %6.1f, sort_elements %6.1f, sort_radix_u64 %6.1f",
+                  count, times[SORT_ALGORITHM_QSORT], times[SORT_ALGORITHM_INTROSORT], times[SORT_ALGORITHM_RADIX]);
+        }
+    }
+
+    afree(scratch, total_count * sizeof(u64), MEMORY_TAG_ARRAY);
+    afree(work, total_count * sizeof(u64), MEMORY_TAG_ARRAY);
+    afree(keys, total_count * sizeof(u64), MEMORY_TAG_ARRAY);
+}
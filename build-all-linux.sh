@@ -23,4 +23,13 @@ then
 echo "Error :"$ERRORLEVEL && exit
 fi
 
+pushd benchmarks
+source build-linux.sh
+popd
+ERRORLEVEL=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+echo "Error :"$ERRORLEVEL && exit
+fi
+
 echo "All assemblies built successfully."
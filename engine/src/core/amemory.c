@@ -4,14 +4,36 @@
 #include "platform/platform.h"
 
 #include "core/astring.h"
+#include "core/event.h"
+#include "core/memory/linear_allocator.h"
+#include "core/memory/dynamic_allocator.h"
+#include "core/memory/allocation_tracker.h"
+#include "core/memory/scratch_allocator.h"
+#include "core/memory/simd_memory.h"
 #include <string.h>
 #include <stdio.h>
 
-struct memory_stats
+// Allocation counters owned by a single thread. Only the owning thread writes them, so
+// allocating never touches a cache line shared with another thread. Counters only grow;
+// the current usage is derived when merging, which also copes with cross-thread frees.
+typedef struct AALIGN(ACACHE_LINE_SIZE) memory_thread_stats
 {
-    u64 total_allocated;
-    u64 tagged_allocations[MEMORY_TAG_MAX_TAGS];
-};
+    u64 allocated_bytes[MEMORY_TAG_MAX_TAGS];
+    u64 freed_bytes[MEMORY_TAG_MAX_TAGS];
+    u64 allocation_count[MEMORY_TAG_MAX_TAGS];
+    u64 free_count[MEMORY_TAG_MAX_TAGS];
+    u64 pool_handed_out[MEMORY_TAG_MAX_TAGS];
+    u64 pool_returned[MEMORY_TAG_MAX_TAGS];
+    // The bytes this thread allocated minus those it freed, and the highest that balance reached,
+    // so a spike shows in the peak even if it is freed before the stats are merged.
+    i64 live_bytes[MEMORY_TAG_MAX_TAGS];
+    i64 peak_bytes[MEMORY_TAG_MAX_TAGS];
+    i64 live_total;
+    i64 peak_total;
+} memory_thread_stats;
+
+// Threads past this count share the last stats block, using atomic updates.
+#define MAX_MEMORY_THREADS 64
 
 static const char* memory_tag_strings[MEMORY_TAG_MAX_TAGS] =
 {
@@ -31,34 +53,457 @@ static const char* memory_tag_strings[MEMORY_TAG_MAX_TAGS] =
     "TRANSFORM  ",
     "ENTITY     ",
     "ENTITY_NODE",
-    "SCENE      "
+    "SCENE      ",
+    "LINEAR_ALLC",
+    "DYNAMIC_ALC"
 };
 
-static struct memory_stats stats;
+static memory_thread_stats thread_stats[MAX_MEMORY_THREADS];
+static u32 thread_stats_count = 0;
+static ATHREAD_LOCAL memory_thread_stats* local_stats = 0;
+static ATHREAD_LOCAL b8 local_stats_shared = FALSE;
+
+static linear_allocator* frame_allocator = 0;
+
+typedef struct tag_budget
+{
+    u64 soft;
+    u64 hard;
+    // The level reported last, events only fire when it goes up.
+    memory_budget_level level;
+} tag_budget;
+
+static tag_budget tag_budgets[MEMORY_TAG_MAX_TAGS];
+
+// Counter values at the start of the frame, and the per-frame deltas of the last frame.
+static u64 frame_start_allocations[MEMORY_TAG_MAX_TAGS];
+static u64 frame_start_bytes[MEMORY_TAG_MAX_TAGS];
+static u64 frame_allocations[MEMORY_TAG_MAX_TAGS];
+static u64 frame_bytes[MEMORY_TAG_MAX_TAGS];
+
+// When running with a budget, every allocation is served from this allocator.
+static b8 use_budget = FALSE;
+static dynamic_allocator budget_allocator;
+static void* budget_memory = 0;
+static volatile i32 budget_lock = 0;
+
+#if AMEMORY_TRACKING_ENABLED
+static volatile i32 tracking_lock = 0;
+#endif
+
+// Large blocks are remembered to report their huge page coverage.
+#define MAX_LARGE_BLOCKS 64
+
+static platform_memory_block large_blocks[MAX_LARGE_BLOCKS];
+static u32 large_block_count = 0;
+static volatile i32 large_block_lock = 0;
+
+static void spin_lock(volatile i32* lock)
+{
+    while (__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE))
+    {
+        while (__atomic_load_n(lock, __ATOMIC_RELAXED))
+        {
+        }
+    }
+}
+
+static void spin_unlock(volatile i32* lock)
+{
+    __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
+
+// Retrieve the stats block of the calling thread, claiming one on first use.
+static memory_thread_stats* get_local_stats()
+{
+    if (!local_stats)
+    {
+        u32 index = __atomic_fetch_add(&thread_stats_count, 1, __ATOMIC_RELAXED);
+        if (index >= MAX_MEMORY_THREADS)
+        {
+            index = MAX_MEMORY_THREADS - 1;
+        }
+        local_stats_shared = index == MAX_MEMORY_THREADS - 1;
+        local_stats = &thread_stats[index];
+    }
+
+    return local_stats;
+}
+
+// Add to a counter of the calling thread's stats block. A plain load/store is enough
+// since the thread is the only writer; it only has to be atomic for readers merging.
+static void stat_add(u64* counter, u64 value)
+{
+    if (local_stats_shared)
+    {
+        __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+    }
+    else
+    {
+        __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+    }
+}
 
-void initialize_memory()
+// Add to a running balance of the calling thread's stats block, raising its peak if needed.
+static void stat_add_live(i64* live, i64* peak, i64 value)
 {
-    platform_zero_memory(&stats, sizeof(stats));
+    if (local_stats_shared)
+    {
+        i64 new_live = __atomic_add_fetch(live, value, __ATOMIC_RELAXED);
+        i64 old_peak = __atomic_load_n(peak, __ATOMIC_RELAXED);
+        while (new_live > old_peak &&
+               !__atomic_compare_exchange_n(peak, &old_peak, new_live, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        {
+        }
+    }
+    else
+    {
+        i64 new_live = __atomic_load_n(live, __ATOMIC_RELAXED) + value;
+        __atomic_store_n(live, new_live, __ATOMIC_RELAXED);
+        if (new_live > __atomic_load_n(peak, __ATOMIC_RELAXED))
+        {
+            __atomic_store_n(peak, new_live, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void stat_allocated(memory_tag tag, u64 size)
+{
+    memory_thread_stats* local = get_local_stats();
+    stat_add(&local->allocated_bytes[tag], size);
+    stat_add_live(&local->live_bytes[tag], &local->peak_bytes[tag], (i64)size);
+    stat_add_live(&local->live_total, &local->peak_total, (i64)size);
+}
+
+static void stat_freed(memory_tag tag, u64 size)
+{
+    memory_thread_stats* local = get_local_stats();
+    stat_add(&local->freed_bytes[tag], size);
+    stat_add_live(&local->live_bytes[tag], &local->peak_bytes[tag], -(i64)size);
+    stat_add_live(&local->live_total, &local->peak_total, -(i64)size);
+}
+
+static void track_allocation(void* block, u64 size, memory_tag tag, const char* file, u32 line)
+{
+    stat_allocated(tag, size);
+    stat_add(&get_local_stats()->allocation_count[tag], 1);
+
+#if AMEMORY_TRACKING_ENABLED
+    spin_lock(&tracking_lock);
+    allocation_tracker_add(block, size, tag, file, line);
+    spin_unlock(&tracking_lock);
+#endif
+}
+
+static void track_free(void* block, u64 size, memory_tag tag)
+{
+    stat_freed(tag, size);
+    stat_add(&get_local_stats()->free_count[tag], 1);
+
+#if AMEMORY_TRACKING_ENABLED
+    spin_lock(&tracking_lock);
+    allocation_tracker_remove(block, size, tag);
+    spin_unlock(&tracking_lock);
+#endif
+}
+
+static void* allocate_large(u64 size, u32 flags)
+{
+    void* block = platform_allocate_large(
+        size,
+        (flags & MEMORY_LARGE_HUGE_PAGES) != 0,
+        (flags & MEMORY_LARGE_PREFAULT) != 0,
+        (flags & MEMORY_LARGE_LOCK) != 0);
+    if (!block)
+    {
+        return 0;
+    }
+
+    // Blocks past the limit still work, they are only missing from the report.
+    spin_lock(&large_block_lock);
+    if (large_block_count < MAX_LARGE_BLOCKS)
+    {
+        large_blocks[large_block_count].block = block;
+        large_blocks[large_block_count].size = size;
+        large_block_count++;
+    }
+    spin_unlock(&large_block_lock);
+
+    return block;
+}
+
+static void free_large(void* block, u64 size)
+{
+    spin_lock(&large_block_lock);
+    for (u32 i = 0; i < large_block_count; ++i)
+    {
+        if (large_blocks[i].block == block)
+        {
+            large_blocks[i] = large_blocks[--large_block_count];
+            break;
+        }
+    }
+    spin_unlock(&large_block_lock);
+
+    platform_free_large(block, size);
+}
+
+b8 initialize_memory(u64 budget, u32 budget_flags)
+{
+    platform_zero_memory(thread_stats, sizeof(thread_stats));
+    simd_memory_initialize();
+    platform_zero_memory(tag_budgets, sizeof(tag_budgets));
+    platform_zero_memory(frame_start_allocations, sizeof(frame_start_allocations));
+    platform_zero_memory(frame_start_bytes, sizeof(frame_start_bytes));
+    platform_zero_memory(frame_allocations, sizeof(frame_allocations));
+    platform_zero_memory(frame_bytes, sizeof(frame_bytes));
+
+#if AMEMORY_TRACKING_ENABLED
+    allocation_tracker_initialize();
+#endif
+
+    use_budget = FALSE;
+    if (budget == 0)
+    {
+        return TRUE;
+    }
+
+    // Reserve the whole budget once.
+    budget_memory = allocate_large(budget, budget_flags);
+    if (!budget_memory || !dynamic_allocator_create(budget, budget_memory, &budget_allocator))
+    {
+        AFATAL("initialize_memory - Failed to reserve a memory budget of %lluB.", budget);
+        if (budget_memory)
+        {
+            free_large(budget_memory, budget);
+        }
+        budget_memory = 0;
+        return FALSE;
+    }
+
+    use_budget = TRUE;
+    return TRUE;
 }
 
 void shutdown_memory()
 {
+#if AMEMORY_TRACKING_ENABLED
+    // Anything still tracked at this point has leaked.
+    spin_lock(&tracking_lock);
+    allocation_tracker_shutdown();
+    spin_unlock(&tracking_lock);
+#endif
+
+    if (use_budget)
+    {
+        u64 budget = budget_allocator.total_size;
+        dynamic_allocator_destroy(&budget_allocator);
+        free_large(budget_memory, budget);
+        budget_memory = 0;
+        use_budget = FALSE;
+    }
+}
+
+// Allocate a block, zeroing it if requested.
+static void* allocate(u64 size, memory_tag tag, b8 zeroed, const char* file, u32 line)
+{
+    void* block;
+    if (use_budget)
+    {
+        spin_lock(&budget_lock);
+        block = dynamic_allocator_allocate(&budget_allocator, size);
+        spin_unlock(&budget_lock);
+        if (!block)
+        {
+            AFATAL(
+                "aallocate - Memory budget exhausted: %lluB requested, %lluB free, largest free block %lluB.",
+                size,
+                budget_allocator.free_size,
+                dynamic_allocator_largest_free_block(&budget_allocator));
+            return 0;
+        }
 
+        // Recycled budget memory must be cleared by hand.
+        if (zeroed)
+        {
+            platform_zero_memory(block, size);
+        }
+    }
+    else
+    {
+        // NOTE: malloc already aligns to 16 bytes on 64-bit platforms, use aallocate_aligned for more.
+        // calloc skips the memset when the pages come fresh from the OS.
+        block = zeroed ? platform_allocate_zeroed(size) : platform_allocate(size, FALSE);
+        if (!block)
+        {
+            AFATAL("aallocate - Failed to allocate %lluB.", size);
+            return 0;
+        }
+    }
+
+    track_allocation(block, size, tag, file, line);
+
+    return block;
 }
 
-void* aallocate(u64 size, memory_tag tag)
+void* _aallocate(u64 size, memory_tag tag, const char* file, u32 line)
 {
     if(tag == MEMORY_TAG_UNKNOWN)
     {
         AWARN("aallocate called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
     }
 
-    stats.total_allocated += size;
-    stats.tagged_allocations[tag] += size;
+    return allocate(size, tag, TRUE, file, line);
+}
+
+void* _aallocate_uninit(u64 size, memory_tag tag, const char* file, u32 line)
+{
+    if(tag == MEMORY_TAG_UNKNOWN)
+    {
+        AWARN("aallocate_uninit called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
+    }
+
+    return allocate(size, tag, FALSE, file, line);
+}
+
+// Allocate an aligned block, zeroing it if requested.
+static void* allocate_aligned(u64 size, u64 alignment, memory_tag tag, b8 zeroed, const char* file, u32 line)
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+    {
+        AERROR("aallocate_aligned - alignment must be a power of two, got %llu.", alignment);
+        return 0;
+    }
+
+    void* block;
+    if (use_budget)
+    {
+        spin_lock(&budget_lock);
+        block = dynamic_allocator_allocate_aligned(&budget_allocator, size, alignment);
+        spin_unlock(&budget_lock);
+        if (!block)
+        {
+            AFATAL(
+                "aallocate_aligned - Memory budget exhausted: %lluB requested, %lluB free, largest free block %lluB.",
+                size,
+                budget_allocator.free_size,
+                dynamic_allocator_largest_free_block(&budget_allocator));
+            return 0;
+        }
+    }
+    else
+    {
+        block = platform_allocate_aligned(size, alignment);
+        if (!block)
+        {
+            AFATAL("aallocate_aligned - Failed to allocate %lluB aligned to %lluB.", size, alignment);
+            return 0;
+        }
+    }
+
+    track_allocation(block, size, tag, file, line);
 
-    // TODO: Memory alignment.
-    void* block = platform_allocate(size, FALSE);
-    platform_zero_memory(block, size);
+    if (zeroed)
+    {
+        platform_zero_memory(block, size);
+    }
+
+    return block;
+}
+
+void* _aallocate_aligned(u64 size, u64 alignment, memory_tag tag, const char* file, u32 line)
+{
+    if(tag == MEMORY_TAG_UNKNOWN)
+    {
+        AWARN("aallocate_aligned called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
+    }
+
+    return allocate_aligned(size, alignment, tag, TRUE, file, line);
+}
+
+void* _aallocate_aligned_uninit(u64 size, u64 alignment, memory_tag tag, const char* file, u32 line)
+{
+    if(tag == MEMORY_TAG_UNKNOWN)
+    {
+        AWARN("aallocate_aligned_uninit called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
+    }
+
+    return allocate_aligned(size, alignment, tag, FALSE, file, line);
+}
+
+void* _areallocate(void* block, u64 old_size, u64 new_size, memory_tag tag, const char* file, u32 line)
+{
+    if(tag == MEMORY_TAG_UNKNOWN)
+    {
+        AWARN("areallocate called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
+    }
+
+    if (!file)
+    {
+        // Keep the call site that allocated the block, the caller is growing it on its behalf.
+        file = __FILE__;
+        line = __LINE__;
+#if AMEMORY_TRACKING_ENABLED
+        if (block)
+        {
+            spin_lock(&tracking_lock);
+            allocation_tracker_find_site(block, &file, &line);
+            spin_unlock(&tracking_lock);
+        }
+#endif
+    }
+
+    if (!block)
+    {
+        return allocate(new_size, tag, FALSE, file, line);
+    }
+
+    if (use_budget)
+    {
+        // The budget allocator can't grow blocks, move them.
+        void* new_block = allocate(new_size, tag, FALSE, file, line);
+        if (!new_block)
+        {
+            return 0;
+        }
+
+        platform_copy_memory(new_block, block, old_size < new_size ? old_size : new_size);
+        afree(block, old_size, tag);
+        return new_block;
+    }
+
+    // Untrack first, the old address may be handed out again as soon as it's released.
+    track_free(block, old_size, tag);
+    void* new_block = platform_reallocate(block, new_size);
+    if (!new_block)
+    {
+        // The old block is still the caller's, track it again.
+        track_allocation(block, old_size, tag, file, line);
+        AFATAL("areallocate - Failed to reallocate %lluB to %lluB.", old_size, new_size);
+        return 0;
+    }
+
+    track_allocation(new_block, new_size, tag, file, line);
+
+    return new_block;
+}
+
+void* _aallocate_large(u64 size, u32 flags, memory_tag tag, const char* file, u32 line)
+{
+    if(tag == MEMORY_TAG_UNKNOWN)
+    {
+        AWARN("aallocate_large called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
+    }
+
+    // Fresh pages from the OS are already zeroed.
+    void* block = allocate_large(size, flags);
+    if (!block)
+    {
+        AFATAL("aallocate_large - Failed to allocate %lluB.", size);
+        return 0;
+    }
+
+    track_allocation(block, size, tag, file, line);
 
     return block;
 }
@@ -70,11 +515,97 @@ void afree(void *block, u64 size, memory_tag tag)
         AWARN("afree called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
     }
 
-    stats.total_allocated -= size;
-    stats.tagged_allocations[tag] -= size;
+    track_free(block, size, tag);
+
+    if (use_budget)
+    {
+        spin_lock(&budget_lock);
+        dynamic_allocator_free(&budget_allocator, block);
+        spin_unlock(&budget_lock);
+    }
+    else
+    {
+        platform_free(block, FALSE);
+    }
+}
+
+void afree_aligned(void *block, u64 size, u64 alignment, memory_tag tag)
+{
+    if(tag == MEMORY_TAG_UNKNOWN)
+    {
+        AWARN("afree_aligned called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
+    }
+
+    track_free(block, size, tag);
+
+    if (use_budget)
+    {
+        // The budget allocator keeps the block offset in its header, alignment doesn't matter.
+        spin_lock(&budget_lock);
+        dynamic_allocator_free(&budget_allocator, block);
+        spin_unlock(&budget_lock);
+    }
+    else
+    {
+        platform_free_aligned(block);
+    }
+}
+
+static u64 page_align(u64 size)
+{
+    u64 page_size = platform_get_page_size();
+    return (size + page_size - 1) & ~(page_size - 1);
+}
+
+void* areserve_memory(u64 size)
+{
+    void* block = platform_reserve_memory(page_align(size));
+    if (!block)
+    {
+        AERROR("areserve_memory - Failed to reserve %lluB of address space.", size);
+    }
+
+    return block;
+}
+
+b8 acommit_memory(void* block, u64 size, memory_tag tag)
+{
+    if (!platform_commit_memory(block, size))
+    {
+        AERROR("acommit_memory - Failed to commit %lluB.", size);
+        return FALSE;
+    }
+
+    // Committed pages only count as allocated bytes, they are not individual allocations.
+    stat_allocated(tag, size);
+    return TRUE;
+}
+
+void adecommit_memory(void* block, u64 size, memory_tag tag)
+{
+    platform_decommit_memory(block, size);
+    stat_freed(tag, size);
+}
+
+void arelease_memory(void* block, u64 size)
+{
+    platform_release_memory(block, page_align(size));
+}
+
+u64 amemory_page_size()
+{
+    return platform_get_page_size();
+}
+
+void afree_large(void *block, u64 size, memory_tag tag)
+{
+    if(tag == MEMORY_TAG_UNKNOWN)
+    {
+        AWARN("afree_large called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
+    }
 
-    // TODO: Memory alignment.
-    platform_free(block, FALSE);
+    track_free(block, size, tag);
+    free_large(block, size);
 }
 
 void *azero_memory(void *block, u64 size)
@@ -84,7 +615,17 @@ void *azero_memory(void *block, u64 size)
 
 void *acopy_memory(void *dest, const void *source, u64 size)
 {
-    return platform_copy_memory(dest, source, size);
+    return simd_copy_memory(dest, source, size);
+}
+
+void *acopy_memory_streaming(void *dest, const void *source, u64 size)
+{
+    return simd_stream_memory(dest, source, size);
+}
+
+void *amove_memory(void *dest, const void *source, u64 size)
+{
+    return platform_move_memory(dest, source, size);
 }
 
 void *aset_memory(void *dest, i32 value, u64 size)
@@ -92,47 +633,361 @@ void *aset_memory(void *dest, i32 value, u64 size)
     return platform_set_memory(dest, value, size);
 }
 
-char *get_memory_usage_str()
+// Split a byte count into a printable amount and unit (B, KiB, MiB, GiB).
+static void memory_size_to_unit(u64 size, f32* out_amount, const char** out_unit)
 {
     const u64 gib = 1024 * 1024 * 1024;
     const u64 mib = 1024 * 1024;
     const u64 kib = 1024;
 
-    char buffer[8000] = "System memory use (tagged):\n";
-    // TODO: Replace strlen with custom one.
-    u64 offset = strlen(buffer);
+    if (size >= gib)
+    {
+        *out_unit = "GiB";
+        *out_amount = size / (f32)gib;
+    }
+    else if (size >= mib)
+    {
+        *out_unit = "MiB";
+        *out_amount = size / (f32)mib;
+    }
+    else if (size >= kib)
+    {
+        *out_unit = "KiB";
+        *out_amount = size / (f32)kib;
+    }
+    else
+    {
+        *out_unit = "B";
+        *out_amount = (f32)size;
+    }
+}
+
+char *get_memory_usage_str()
+{
+    const u64 buffer_size = 8000;
+    scratch_marker marker = scratch_mark();
+    char* buffer = scratch_allocate(buffer_size);
+    if (!buffer)
+    {
+        AERROR("get_memory_usage_str - Failed to allocate scratch memory.");
+        return 0;
+    }
+    u64 offset = snprintf(buffer, buffer_size, "System memory use (tagged, %s copies):\n", simd_memory_path_name());
+
+    memory_stats stats;
+    memory_get_stats(&stats);
     for(u32 i = 0; i < MEMORY_TAG_MAX_TAGS; ++i)
     {
-        char unit[4] = "XiB";
-        float amount = 1.0f;
-        if(stats.tagged_allocations[i] >= gib)
-        {
-            unit[0] = 'G';
-            amount = stats.tagged_allocations[i] / (float)gib;
-        }
-        else if(stats.tagged_allocations[i] >= mib)
+        const char* unit;
+        f32 amount;
+        memory_size_to_unit(stats.tags[i].allocated, &amount, &unit);
+        const char* peak_unit;
+        f32 peak;
+        memory_size_to_unit(stats.tags[i].peak, &peak, &peak_unit);
+
+        i32 length = snprintf(
+            buffer + offset,
+            buffer_size - offset,
+            "  %s: %.2f%s (peak: %.2f%s, live: %llu, allocations: %llu, last frame: %llu)\n",
+            memory_tag_strings[i],
+            amount,
+            unit,
+            peak,
+            peak_unit,
+            stats.tags[i].live_count,
+            stats.tags[i].allocation_count,
+            stats.tags[i].frame_allocation_count);
+        offset += length;
+
+        if (stats.tags[i].soft_budget || stats.tags[i].hard_budget)
         {
-            unit[0] = 'M';
-            amount = stats.tagged_allocations[i] / (float)mib;
+            const char* soft_unit;
+            f32 soft;
+            memory_size_to_unit(stats.tags[i].soft_budget, &soft, &soft_unit);
+            const char* hard_unit;
+            f32 hard;
+            memory_size_to_unit(stats.tags[i].hard_budget, &hard, &hard_unit);
+            length = snprintf(
+                buffer + offset,
+                buffer_size - offset,
+                "    budget: soft %.2f%s, hard %.2f%s\n",
+                soft,
+                soft_unit,
+                hard,
+                hard_unit);
+            offset += length;
         }
-        else if(stats.tagged_allocations[i] >= kib)
+    }
+
+    for(u32 i = 0; i < MEMORY_TAG_MAX_TAGS; ++i)
+    {
+        if (stats.tags[i].pool_usage == 0)
         {
-            unit[0] = 'K';
-            amount = stats.tagged_allocations[i] / (float)kib;
+            continue;
         }
-        else
+
+        const char* unit;
+        f32 amount;
+        memory_size_to_unit(stats.tags[i].pool_usage, &amount, &unit);
+
+        i32 length = snprintf(buffer + offset, buffer_size - offset, "  %s: %.2f%s (pooled)\n", memory_tag_strings[i], amount, unit);
+        offset += length;
+    }
+
+    if (use_budget)
+    {
+        memory_budget_stats budget_stats;
+        memory_get_budget_stats(&budget_stats);
+
+        const char* used_unit;
+        f32 used;
+        memory_size_to_unit(budget_stats.total_size - budget_stats.free_size, &used, &used_unit);
+        const char* total_unit;
+        f32 total;
+        memory_size_to_unit(budget_stats.total_size, &total, &total_unit);
+        const char* largest_unit;
+        f32 largest;
+        memory_size_to_unit(budget_stats.largest_free_block, &largest, &largest_unit);
+
+        i32 length = snprintf(
+            buffer + offset,
+            buffer_size - offset,
+            "Memory budget:\n  used: %.2f%s / %.2f%s, largest free block: %.2f%s, fragmentation: %.1f%%\n",
+            used,
+            used_unit,
+            total,
+            total_unit,
+            largest,
+            largest_unit,
+            budget_stats.fragmentation * 100.0f);
+        offset += length;
+    }
+
+    if (frame_allocator)
+    {
+        const char* capacity_unit;
+        f32 capacity;
+        memory_size_to_unit(frame_allocator->total_size, &capacity, &capacity_unit);
+        const char* high_water_unit;
+        f32 high_water;
+        memory_size_to_unit(frame_allocator->high_water_mark, &high_water, &high_water_unit);
+
+        i32 length = snprintf(
+            buffer + offset,
+            buffer_size - offset,
+            "Frame allocator:\n  capacity: %.2f%s, high-water: %.2f%s, overflows: %llu\n",
+            capacity,
+            capacity_unit,
+            high_water,
+            high_water_unit,
+            frame_allocator->overflow_count);
+        offset += length;
+    }
+
+    // Query the huge pages on a copy, the OS walks every mapping and the lock would be held throughout.
+    platform_memory_block blocks[MAX_LARGE_BLOCKS];
+    spin_lock(&large_block_lock);
+    u32 block_count = large_block_count;
+    platform_copy_memory(blocks, large_blocks, block_count * sizeof(platform_memory_block));
+    spin_unlock(&large_block_lock);
+
+    if (block_count)
+    {
+        u64 large_size = 0;
+        for (u32 i = 0; i < block_count; ++i)
         {
-            unit[0] = 'B';
-            unit[1] = 0;
-            amount = (float)stats.tagged_allocations[i];
+            large_size += blocks[i].size;
         }
+        u64 huge_size = platform_get_huge_page_bytes(blocks, block_count);
+
+        const char* large_unit;
+        f32 large;
+        memory_size_to_unit(large_size, &large, &large_unit);
+        const char* huge_unit;
+        f32 huge;
+        memory_size_to_unit(huge_size, &huge, &huge_unit);
 
-        i32 length = snprintf(buffer + offset, 8000, "  %s: %.2f%s\n", memory_tag_strings[i], amount, unit);
+        i32 length = snprintf(
+            buffer + offset,
+            buffer_size - offset,
+            "Large blocks:\n  count: %u, size: %.2f%s, huge pages: %.2f%s (%.1f%%)\n",
+            block_count,
+            large,
+            large_unit,
+            huge,
+            huge_unit,
+            huge_size * 100.0f / large_size);
         offset += length;
     }
 
-
     char* out_string = string_duplicate(buffer);
+    scratch_restore(marker);
 
     return out_string;
 }
+
+const char *memory_tag_name(memory_tag tag)
+{
+    return tag < MEMORY_TAG_MAX_TAGS ? memory_tag_strings[tag] : "INVALID    ";
+}
+
+// Sum the counters of every thread. out_allocated_bytes receives the gross number of bytes allocated per tag.
+static void merge_thread_stats(memory_stats* out_stats, u64* out_allocated_bytes)
+{
+    platform_zero_memory(out_stats, sizeof(memory_stats));
+
+    u32 thread_count = __atomic_load_n(&thread_stats_count, __ATOMIC_RELAXED);
+    if (thread_count > MAX_MEMORY_THREADS)
+    {
+        thread_count = MAX_MEMORY_THREADS;
+    }
+
+    u64 freed[MEMORY_TAG_MAX_TAGS] = {0};
+    u64 pool_returned[MEMORY_TAG_MAX_TAGS] = {0};
+    i64 peaks[MEMORY_TAG_MAX_TAGS] = {0};
+    i64 total_peak = 0;
+    for (u32 t = 0; t < thread_count; ++t)
+    {
+        memory_thread_stats* thread = &thread_stats[t];
+        for (u32 i = 0; i < MEMORY_TAG_MAX_TAGS; ++i)
+        {
+            out_stats->tags[i].allocated += __atomic_load_n(&thread->allocated_bytes[i], __ATOMIC_RELAXED);
+            freed[i] += __atomic_load_n(&thread->freed_bytes[i], __ATOMIC_RELAXED);
+            out_stats->tags[i].allocation_count += __atomic_load_n(&thread->allocation_count[i], __ATOMIC_RELAXED);
+            out_stats->tags[i].free_count += __atomic_load_n(&thread->free_count[i], __ATOMIC_RELAXED);
+            out_stats->tags[i].pool_usage += __atomic_load_n(&thread->pool_handed_out[i], __ATOMIC_RELAXED);
+            pool_returned[i] += __atomic_load_n(&thread->pool_returned[i], __ATOMIC_RELAXED);
+            peaks[i] += __atomic_load_n(&thread->peak_bytes[i], __ATOMIC_RELAXED);
+        }
+        total_peak += __atomic_load_n(&thread->peak_total, __ATOMIC_RELAXED);
+    }
+
+    for (u32 i = 0; i < MEMORY_TAG_MAX_TAGS; ++i)
+    {
+        // A free racing with the merge may be seen before its allocation, never go below zero.
+        memory_tag_stats* tag = &out_stats->tags[i];
+        out_allocated_bytes[i] = tag->allocated;
+        tag->allocated = tag->allocated > freed[i] ? tag->allocated - freed[i] : 0;
+        tag->pool_usage = tag->pool_usage > pool_returned[i] ? tag->pool_usage - pool_returned[i] : 0;
+        tag->live_count = tag->allocation_count > tag->free_count ? tag->allocation_count - tag->free_count : 0;
+        tag->frame_allocation_count = frame_allocations[i];
+        tag->frame_allocated = frame_bytes[i];
+        tag->soft_budget = tag_budgets[i].soft;
+        tag->hard_budget = tag_budgets[i].hard;
+        out_stats->total_allocated += tag->allocated;
+
+        // Every thread's peak is summed, whether or not they happened at the same time.
+        tag->peak = (u64)peaks[i] > tag->allocated ? (u64)peaks[i] : tag->allocated;
+    }
+
+    out_stats->total_peak = (u64)total_peak > out_stats->total_allocated ? (u64)total_peak : out_stats->total_allocated;
+}
+
+void memory_get_stats(memory_stats *out_stats)
+{
+    u64 allocated_bytes[MEMORY_TAG_MAX_TAGS];
+    merge_thread_stats(out_stats, allocated_bytes);
+}
+
+void memory_end_frame()
+{
+    memory_stats stats;
+    u64 allocated_bytes[MEMORY_TAG_MAX_TAGS];
+    merge_thread_stats(&stats, allocated_bytes);
+
+    for (u32 i = 0; i < MEMORY_TAG_MAX_TAGS; ++i)
+    {
+        frame_allocations[i] = stats.tags[i].allocation_count - frame_start_allocations[i];
+        frame_bytes[i] = allocated_bytes[i] - frame_start_bytes[i];
+        frame_start_allocations[i] = stats.tags[i].allocation_count;
+        frame_start_bytes[i] = allocated_bytes[i];
+
+        tag_budget* budget = &tag_budgets[i];
+        if (!budget->soft && !budget->hard)
+        {
+            continue;
+        }
+
+        u64 allocated = stats.tags[i].allocated;
+        memory_budget_level level = MEMORY_BUDGET_WITHIN;
+        if (budget->hard && allocated > budget->hard)
+        {
+            level = MEMORY_BUDGET_HARD_EXCEEDED;
+        }
+        else if (budget->soft && allocated > budget->soft)
+        {
+            level = MEMORY_BUDGET_SOFT_EXCEEDED;
+        }
+
+        // Only report crossings, not every frame spent over budget.
+        if (level > budget->level)
+        {
+            AWARN(
+                "Memory tag %s is over its %s budget: %lluB allocated, %lluB allowed.",
+                memory_tag_strings[i],
+                level == MEMORY_BUDGET_HARD_EXCEEDED ? "hard" : "soft",
+                allocated,
+                level == MEMORY_BUDGET_HARD_EXCEEDED ? budget->hard : budget->soft);
+
+            event_context context;
+            context.data.u32[0] = i;
+            context.data.u32[1] = level;
+            context.data.u64[1] = allocated;
+            event_fire(EVENT_CODE_MEMORY_BUDGET_EXCEEDED, 0, context);
+        }
+        budget->level = level;
+    }
+
+#if AMEMORY_TRACKING_ENABLED
+    spin_lock(&tracking_lock);
+    allocation_tracker_end_frame();
+    spin_unlock(&tracking_lock);
+#endif
+}
+
+b8 memory_get_budget_stats(memory_budget_stats *out_stats)
+{
+    if (!use_budget)
+    {
+        return FALSE;
+    }
+
+    spin_lock(&budget_lock);
+    out_stats->total_size = budget_allocator.total_size;
+    out_stats->free_size = budget_allocator.free_size;
+    out_stats->largest_free_block = dynamic_allocator_largest_free_block(&budget_allocator);
+    out_stats->fragmentation = dynamic_allocator_fragmentation(&budget_allocator);
+    spin_unlock(&budget_lock);
+    return TRUE;
+}
+
+void memory_set_tag_budget(memory_tag tag, u64 soft_budget, u64 hard_budget)
+{
+    if (tag >= MEMORY_TAG_MAX_TAGS)
+    {
+        AERROR("memory_set_tag_budget called with an invalid tag %u.", tag);
+        return;
+    }
+
+    tag_budgets[tag].soft = soft_budget;
+    tag_budgets[tag].hard = hard_budget;
+    tag_budgets[tag].level = MEMORY_BUDGET_WITHIN;
+}
+
+void memory_register_frame_allocator(linear_allocator *allocator)
+{
+    frame_allocator = allocator;
+}
+
+void memory_report_pool_usage(memory_tag tag, i64 delta)
+{
+    memory_thread_stats* local = get_local_stats();
+    if (delta >= 0)
+    {
+        stat_add(&local->pool_handed_out[tag], (u64)delta);
+    }
+    else
+    {
+        stat_add(&local->pool_returned[tag], (u64)-delta);
+    }
+}
@@ -2,6 +2,19 @@
 
 #include "defines.h"
 
+// Tracking records the call site of every live allocation, to report leaks at shutdown
+// and the call sites allocating the most every frame. On by default in debug builds.
+// Containers take the __FILE__ and __LINE__ of their create macros and pass them to the
+// _aallocate functions, so their memory is reported where they were created rather than
+// inside the container. Blocks they grow with _areallocate keep that call site.
+#ifndef AMEMORY_TRACKING_ENABLED
+#ifdef _DEBUG
+#define AMEMORY_TRACKING_ENABLED 1
+#else
+#define AMEMORY_TRACKING_ENABLED 0
+#endif
+#endif
+
 typedef enum memory_tag 
 {
     // For temporary use. Should be assigned one of the below or have a new tag created.
@@ -23,16 +36,289 @@ typedef enum memory_tag
     MEMORY_TAG_ENTITY,
     MEMORY_TAG_ENTITY_NODE,
     MEMORY_TAG_SCENE,
+    MEMORY_TAG_LINEAR_ALLOCATOR,
+    MEMORY_TAG_DYNAMIC_ALLOCATOR,
 
     MEMORY_TAG_MAX_TAGS
 } memory_tag;
 
-AAPI void initialize_memory();
+// Merged allocation statistics of a single tag.
+typedef struct memory_tag_stats
+{
+    // The number of bytes currently allocated.
+    u64 allocated;
+    // The highest number of bytes allocated at once, updated on every allocation.
+    // NOTE: The sum of each thread's peak. Exact when a single thread allocates and frees with the
+    // tag, an upper bound when several do or blocks are freed on another thread.
+    u64 peak;
+    // The total number of allocations made since initialization.
+    u64 allocation_count;
+    // The total number of frees made since initialization.
+    u64 free_count;
+    // The number of bytes handed out by pool allocators, out of 'allocated'.
+    u64 pool_usage;
+    // The number of allocations currently alive.
+    u64 live_count;
+    // The number of allocations made during the last frame.
+    u64 frame_allocation_count;
+    // The number of bytes allocated during the last frame, regardless of frees.
+    u64 frame_allocated;
+    // The budgets set with memory_set_tag_budget, 0 when unset.
+    u64 soft_budget;
+    u64 hard_budget;
+} memory_tag_stats;
+
+typedef enum memory_budget_level
+{
+    MEMORY_BUDGET_WITHIN,
+    MEMORY_BUDGET_SOFT_EXCEEDED,
+    MEMORY_BUDGET_HARD_EXCEEDED
+} memory_budget_level;
+
+// Merged allocation statistics of every thread.
+typedef struct memory_stats
+{
+    // The number of bytes currently allocated, all tags included.
+    u64 total_allocated;
+    // The highest number of bytes allocated at once, all tags included. Summed like the tag peaks.
+    u64 total_peak;
+    memory_tag_stats tags[MEMORY_TAG_MAX_TAGS];
+} memory_stats;
+
+typedef struct memory_budget_stats
+{
+    // The size of the memory budget, in bytes.
+    u64 total_size;
+    // The number of bytes still free in the budget.
+    u64 free_size;
+    // The largest allocation the budget can currently serve, in bytes: the largest contiguous
+    // free block minus the per-block overhead.
+    u64 largest_free_block;
+    // 1 - the size of the largest free block / free_size. 0 means all the free space is contiguous.
+    f32 fragmentation;
+} memory_budget_stats;
+
+// Options for large, long-lived blocks allocated with aallocate_large.
+typedef enum memory_large_flags
+{
+    MEMORY_LARGE_NONE = 0x0,
+    // Back the block with huge pages when the OS allows it, to cut TLB misses.
+    MEMORY_LARGE_HUGE_PAGES = 0x1,
+    // Fault every page in at allocation time rather than on first touch.
+    MEMORY_LARGE_PREFAULT = 0x2,
+    // Prefault and pin the pages in RAM.
+    MEMORY_LARGE_LOCK = 0x4
+} memory_large_flags;
+
+/**
+ * Initialize the memory subsystem.
+ * @param budget The total number of bytes the engine may allocate. If non-zero, this amount is
+ * reserved once and every aallocate/afree is served from it. If zero, allocations go straight
+ * to the platform and are unbounded.
+ * @param budget_flags A combination of memory_large_flags used to allocate the budget.
+ * @return TRUE on success; otherwise FALSE.
+ */
+AAPI b8 initialize_memory(u64 budget, u32 budget_flags);
 AAPI void shutdown_memory();
 
-AAPI void* aallocate(u64 suze, memory_tag tag);
+AAPI void* _aallocate(u64 size, memory_tag tag, const char* file, u32 line);
+AAPI void* _aallocate_uninit(u64 size, memory_tag tag, const char* file, u32 line);
+AAPI void* _aallocate_aligned(u64 size, u64 alignment, memory_tag tag, const char* file, u32 line);
+AAPI void* _aallocate_aligned_uninit(u64 size, u64 alignment, memory_tag tag, const char* file, u32 line);
+
+AAPI void* _areallocate(void* block, u64 old_size, u64 new_size, memory_tag tag, const char* file, u32 line);
+AAPI void* _aallocate_large(u64 size, u32 flags, memory_tag tag, const char* file, u32 line);
+
 AAPI void afree(void* block, u64 size, memory_tag tag);
+
+/**
+ * Free a block allocated with aallocate_aligned.
+ * @param block A pointer to the block to free.
+ * @param size The size that was requested when allocating this block.
+ * @param alignment The alignment that was requested when allocating this block.
+ * @param tag The tag of the allocation.
+ */
+AAPI void afree_aligned(void* block, u64 size, u64 alignment, memory_tag tag);
+
+/**
+ * Free a block allocated with aallocate_large.
+ * @param block A pointer to the block to free.
+ * @param size The size that was requested when allocating this block.
+ * @param tag The tag of the allocation.
+ */
+AAPI void afree_large(void* block, u64 size, memory_tag tag);
+
+/**
+ * Allocate a zeroed block.
+ * @param size The number of bytes to allocate.
+ * @param tag The tag of the allocation.
+ * @return A pointer to the block, or 0/NULL on failure.
+ */
+#define aallocate(size, tag) \
+    _aallocate(size, tag, __FILE__, __LINE__)
+
+/**
+ * Allocate a block without zeroing it. Use it for blocks that are about to be overwritten
+ * anyway. Freed with afree.
+ * @param size The number of bytes to allocate.
+ * @param tag The tag of the allocation.
+ * @return A pointer to the block, or 0/NULL on failure.
+ */
+#define aallocate_uninit(size, tag) \
+    _aallocate_uninit(size, tag, __FILE__, __LINE__)
+
+/**
+ * Allocate a zeroed block aligned to the given boundary. Freed with afree_aligned.
+ * @param size The number of bytes to allocate.
+ * @param alignment The alignment of the block, in bytes. Must be a power of two.
+ * @param tag The tag of the allocation.
+ * @return A pointer to the block, or 0/NULL on failure.
+ */
+#define aallocate_aligned(size, alignment, tag) \
+    _aallocate_aligned(size, alignment, tag, __FILE__, __LINE__)
+
+/**
+ * Allocate a block aligned to the given boundary without zeroing it. Use it for blocks that are
+ * about to be overwritten anyway. Freed with afree_aligned.
+ * @param size The number of bytes to allocate.
+ * @param alignment The alignment of the block, in bytes. Must be a power of two.
+ * @param tag The tag of the allocation.
+ * @return A pointer to the block, or 0/NULL on failure.
+ */
+#define aallocate_aligned_uninit(size, alignment, tag) \
+    _aallocate_aligned_uninit(size, alignment, tag, __FILE__, __LINE__)
+
+/**
+ * Reserve a range of address space without backing it with memory. Pages must be committed
+ * with acommit_memory before use. Reservations bypass the memory budget.
+ * @param size The number of bytes to reserve. Rounded up to the page size.
+ * @return A pointer to the reserved range, or 0/NULL on failure.
+ */
+AAPI void* areserve_memory(u64 size);
+
+/**
+ * Back a range of reserved memory with zeroed pages, accounting for it under the given tag.
+ * @param block A page-aligned pointer inside a reserved range.
+ * @param size The number of bytes to commit. Must be a multiple of the page size.
+ * @param tag The tag to account the committed memory under.
+ * @return TRUE on success; otherwise FALSE.
+ */
+AAPI b8 acommit_memory(void* block, u64 size, memory_tag tag);
+
+/**
+ * Return committed pages to the OS, keeping the address range reserved.
+ * @param block A page-aligned pointer inside a reserved range.
+ * @param size The number of bytes to decommit. Must be a multiple of the page size.
+ * @param tag The tag the memory was committed under.
+ */
+AAPI void adecommit_memory(void* block, u64 size, memory_tag tag);
+
+/**
+ * Release a reserved range. Committed pages must be decommitted first to keep the stats right.
+ * @param block A pointer returned by areserve_memory.
+ * @param size The size that was requested when reserving the range.
+ */
+AAPI void arelease_memory(void* block, u64 size);
+
+// Return the granularity of acommit_memory, in bytes.
+AAPI u64 amemory_page_size();
+
+/**
+ * Resize a block allocated with aallocate or aallocate_uninit, growing it in place when the
+ * platform allocator can. The contents are kept up to the smaller size; the grown part is NOT
+ * zeroed. Freed with afree using the new size. Calling _areallocate with a 0/NULL file keeps
+ * the call site that allocated the block, for containers growing memory on their caller's behalf.
+ * @param block A pointer to the block to resize. If 0/NULL, a new block is allocated.
+ * @param old_size The current size of the block.
+ * @param new_size The new size of the block.
+ * @param tag The tag of the allocation.
+ * @return A pointer to the resized block, which may have moved, or 0/NULL on failure.
+ */
+#define areallocate(block, old_size, new_size, tag) \
+    _areallocate(block, old_size, new_size, tag, __FILE__, __LINE__)
+
+/**
+ * Allocate a large, long-lived, zeroed block straight from the OS, such as an arena. The block
+ * is page-aligned and bypasses the memory budget. Freed with afree_large.
+ * @param size The number of bytes to allocate.
+ * @param flags A combination of memory_large_flags.
+ * @param tag The tag of the allocation.
+ * @return A pointer to the block, or 0/NULL on failure.
+ */
+#define aallocate_large(size, flags, tag) \
+    _aallocate_large(size, flags, tag, __FILE__, __LINE__)
+
 AAPI void* azero_memory(void* block, u64 size);
 AAPI void* acopy_memory(void* dest, const void* source, u64 size);
+
+/**
+ * Copy a block without pulling the destination into the cache, for data that won't be read
+ * back soon such as upload staging and snapshots. Falls back to acopy_memory for small blocks.
+ * @param dest A pointer to the destination.
+ * @param source A pointer to the source.
+ * @param size The number of bytes to copy.
+ * @return dest.
+ */
+AAPI void* acopy_memory_streaming(void* dest, const void* source, u64 size);
+/**
+ * Copy a block to a range that may overlap it.
+ * @param dest A pointer to the destination.
+ * @param source A pointer to the source.
+ * @param size The number of bytes to copy.
+ * @return dest.
+ */
+AAPI void* amove_memory(void* dest, const void* source, u64 size);
+
 AAPI void* aset_memory(void* dest, i32 value, u64 size);
 AAPI char* get_memory_usage_str();
+
+// Return the display name of a memory tag.
+AAPI const char* memory_tag_name(memory_tag tag);
+
+/**
+ * Merge the statistics of every thread. Allocations only ever update counters owned
+ * by the calling thread, the merge happens here.
+ * @param out_stats A pointer to hold the merged stats.
+ */
+AAPI void memory_get_stats(memory_stats* out_stats);
+
+/**
+ * Notify the memory subsystem that a frame ended. This computes the per-frame counters and
+ * checks the tag budgets. In tracking builds, it also reports the call sites that allocated
+ * the most during the frame.
+ */
+AAPI void memory_end_frame();
+
+/**
+ * Retrieve the state of the memory budget.
+ * @param out_stats A pointer to hold the stats.
+ * @return TRUE if the memory subsystem runs with a budget; otherwise FALSE.
+ */
+AAPI b8 memory_get_budget_stats(memory_budget_stats* out_stats);
+
+/**
+ * Set the budgets of a tag. Budgets are checked at the end of every frame; when the bytes
+ * allocated under the tag go over one, EVENT_CODE_MEMORY_BUDGET_EXCEEDED is fired. It fires
+ * again only once the tag went back under the budget. Allocations are never refused.
+ * @param tag The tag to set the budgets of.
+ * @param soft_budget The number of bytes the tag should stay under, 0 for none.
+ * @param hard_budget The number of bytes the tag must stay under, 0 for none.
+ */
+AAPI void memory_set_tag_budget(memory_tag tag, u64 soft_budget, u64 hard_budget);
+
+struct linear_allocator;
+
+/**
+ * Register the linear allocator used for per-frame transient allocations, so its
+ * usage is reported by get_memory_usage_str. Pass 0/NULL to unregister it.
+ * @param allocator A pointer to the frame allocator.
+ */
+AAPI void memory_register_frame_allocator(struct linear_allocator* allocator);
+
+/**
+ * Report a change in the number of bytes handed out by a pool allocator, so pool usage
+ * can be tracked per tag. The memory backing the pools is accounted for by aallocate.
+ * @param tag The tag of the pool.
+ * @param delta The number of bytes handed out (positive) or returned (negative).
+ */
+AAPI void memory_report_pool_usage(memory_tag tag, i64 delta);
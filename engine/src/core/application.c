@@ -7,6 +7,7 @@
 #include "core/event.h"
 #include "core/input.h"
 #include "core/clock.h"
+#include "core/memory/linear_allocator.h"
 
 #include "renderer/renderer_frontend.h"
 
@@ -20,8 +21,15 @@ typedef struct application_state
     i16 height;
     clock clock;
     f64 last_time;
+    // Transient memory, reclaimed at the end of every frame.
+    linear_allocator frame_allocator;
+    // The block backing the frame allocator, from aallocate_large.
+    void* frame_memory;
 } application_state;
 
+// The size of the per-frame transient memory block.
+#define FRAME_ALLOCATOR_SIZE (8 * 1024 * 1024)
+
 static b8 initialized = FALSE;
 static application_state app_state;
 
@@ -41,6 +49,19 @@ b8 application_create(game *game_inst)
     // Initialize subsystems.
     initialize_logging();
 
+    // Touched every frame, so worth huge pages and faulting in up front.
+    app_state.frame_memory = aallocate_large(
+        FRAME_ALLOCATOR_SIZE,
+        MEMORY_LARGE_HUGE_PAGES | MEMORY_LARGE_PREFAULT,
+        MEMORY_TAG_LINEAR_ALLOCATOR);
+    if (!app_state.frame_memory)
+    {
+        AFATAL("Failed to allocate the frame allocator. Application cannot continue.");
+        return FALSE;
+    }
+    linear_allocator_create(FRAME_ALLOCATOR_SIZE, app_state.frame_memory, &app_state.frame_allocator);
+    memory_register_frame_allocator(&app_state.frame_allocator);
+
     if (!initialize_events())
     {
         AFATAL("Event system failed initialization. Application cannot continue.");
@@ -169,6 +190,10 @@ b8 application_run()
             // frame ends.
             update_inputs(delta);
 
+            // Everything allocated from the frame allocator dies with the frame.
+            linear_allocator_free_all(&app_state.frame_allocator);
+            memory_end_frame();
+
             // Update last time
             clock_update(&app_state.clock);
         }
@@ -188,11 +213,25 @@ b8 application_run()
     shutdown_renderer();
 
     platform_shutdown(&app_state.platform);
+
+    memory_register_frame_allocator(0);
+    linear_allocator_destroy(&app_state.frame_allocator);
+    if (app_state.frame_memory)
+    {
+        afree_large(app_state.frame_memory, FRAME_ALLOCATOR_SIZE, MEMORY_TAG_LINEAR_ALLOCATOR);
+        app_state.frame_memory = 0;
+    }
+
     shutdown_logging();
 
     return TRUE;
 }
 
+linear_allocator *application_get_frame_allocator()
+{
+    return &app_state.frame_allocator;
+}
+
 b8 application_on_event(u16 code, void *sender, void *listener_inst, event_context context)
 {
     switch (code)
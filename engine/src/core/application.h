@@ -3,6 +3,7 @@
 #include "defines.h"
 
 struct game;
+struct linear_allocator;
 
 typedef struct application_config
 {
@@ -24,3 +25,11 @@ typedef struct application_config
 
 AAPI b8 application_create(struct game* game_inst);
 AAPI b8 application_run();
+
+
+/**
+ * Retrieve the per-frame allocator. Everything allocated from it is reclaimed
+ * at the end of the current frame, so it should only be used for transient data.
+ * @return A pointer to the frame allocator.
+ */
+AAPI struct linear_allocator* application_get_frame_allocator();
@@ -0,0 +1,296 @@
+#include "bitset.h"
+
+#include "core/logger.h"
+#include "core/memory/simd_memory.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BITSET_X86 1
+#include <immintrin.h>
+#else
+#define BITSET_X86 0
+#endif
+
+// The dynamic bitset words are allocated a whole AVX2 vector at a time.
+#define BITSET_VECTOR_WORDS 4
+#define BITSET_VECTOR_ALIGNMENT 32
+
+static inline b8 take_avx2(u64 word_count)
+{
+    return BITSET_X86 && word_count >= BITSET_SIMD_MIN_WORDS && simd_cpu_has_avx2();
+}
+
+// Generate a word-wise operation: a scalar loop, an AVX2 loop finishing the tail scalar, and the
+// function picking between them.
+#if BITSET_X86
+#define BITSET_BINARY_OPERATION(name, scalar_expression, vector_expression)                       \
+    __attribute__((target("avx2")))                                                               \
+    static void name##_avx2(u64* dest, const u64* source, u64 word_count)                         \
+    {                                                                                             \
+        u64 i = 0;                                                                                \
+        for (; i + BITSET_VECTOR_WORDS <= word_count; i += BITSET_VECTOR_WORDS)                   \
+        {                                                                                         \
+            __m256i d = _mm256_loadu_si256((const __m256i*)(dest + i));                           \
+            __m256i s = _mm256_loadu_si256((const __m256i*)(source + i));                         \
+            _mm256_storeu_si256((__m256i*)(dest + i), vector_expression);                         \
+        }                                                                                         \
+        for (; i < word_count; ++i)                                                               \
+        {                                                                                         \
+            u64 d = dest[i];                                                                      \
+            u64 s = source[i];                                                                    \
+            dest[i] = scalar_expression;                                                          \
+        }                                                                                         \
+    }                                                                                             \
+                                                                                                  \
+    void name(u64* dest, const u64* source, u64 word_count)                                       \
+    {                                                                                             \
+        if (take_avx2(word_count))                                                                \
+        {                                                                                         \
+            name##_avx2(dest, source, word_count);                                                \
+            return;                                                                               \
+        }                                                                                         \
+        for (u64 i = 0; i < word_count; ++i)                                                      \
+        {                                                                                         \
+            u64 d = dest[i];                                                                      \
+            u64 s = source[i];                                                                    \
+            dest[i] = scalar_expression;                                                          \
+        }                                                                                         \
+    }
+#else
+#define BITSET_BINARY_OPERATION(name, scalar_expression, vector_expression) \
+    void name(u64* dest, const u64* source, u64 word_count)                 \
+    {                                                                       \
+        for (u64 i = 0; i < word_count; ++i)                                \
+        {                                                                   \
+            u64 d = dest[i];                                                \
+            u64 s = source[i];                                              \
+            dest[i] = scalar_expression;                                    \
+        }                                                                   \
+    }
+#endif
+
+BITSET_BINARY_OPERATION(bitset_words_and, d & s, _mm256_and_si256(d, s))
+BITSET_BINARY_OPERATION(bitset_words_or, d | s, _mm256_or_si256(d, s))
+BITSET_BINARY_OPERATION(bitset_words_andnot, d & ~s, _mm256_andnot_si256(s, d))
+BITSET_BINARY_OPERATION(bitset_words_xor, d ^ s, _mm256_xor_si256(d, s))
+
+#if BITSET_X86
+__attribute__((target("avx2"))) static u64 count_avx2(const u64* words, u64 word_count)
+{
+    // Look up the bit count of each nibble, then sum the byte counts of each 64-bit lane.
+    const __m256i nibble_counts = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0F);
+    __m256i total = _mm256_setzero_si256();
+
+    u64 i = 0;
+    for (; i + BITSET_VECTOR_WORDS <= word_count; i += BITSET_VECTOR_WORDS)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(words + i));
+        __m256i low = _mm256_shuffle_epi8(nibble_counts, _mm256_and_si256(v, low_nibbles));
+        __m256i high = _mm256_shuffle_epi8(nibble_counts, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibbles));
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+    }
+
+    __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+    u64 result = (u64)_mm_cvtsi128_si64(sum) + (u64)_mm_extract_epi64(sum, 1);
+    for (; i < word_count; ++i)
+    {
+        result += (u64)__builtin_popcountll(words[i]);
+    }
+    return result;
+}
+
+__attribute__((target("avx2"))) static b8 contains_all_avx2(const u64* words, const u64* mask, u64 word_count)
+{
+    u64 i = 0;
+    for (; i + BITSET_VECTOR_WORDS <= word_count; i += BITSET_VECTOR_WORDS)
+    {
+        // testc is 1 when every bit of the mask is set in the words.
+        __m256i w = _mm256_loadu_si256((const __m256i*)(words + i));
+        __m256i m = _mm256_loadu_si256((const __m256i*)(mask + i));
+        if (!_mm256_testc_si256(w, m))
+        {
+            return FALSE;
+        }
+    }
+    for (; i < word_count; ++i)
+    {
+        if (mask[i] & ~words[i])
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+__attribute__((target("avx2"))) static b8 intersects_avx2(const u64* a, const u64* b, u64 word_count)
+{
+    u64 i = 0;
+    for (; i + BITSET_VECTOR_WORDS <= word_count; i += BITSET_VECTOR_WORDS)
+    {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        if (!_mm256_testz_si256(va, vb))
+        {
+            return TRUE;
+        }
+    }
+    for (; i < word_count; ++i)
+    {
+        if (a[i] & b[i])
+        {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+#endif
+
+u64 bitset_words_count(const u64* words, u64 word_count)
+{
+#if BITSET_X86
+    if (take_avx2(word_count))
+    {
+        return count_avx2(words, word_count);
+    }
+#endif
+    u64 result = 0;
+    for (u64 i = 0; i < word_count; ++i)
+    {
+        result += (u64)__builtin_popcountll(words[i]);
+    }
+    return result;
+}
+
+b8 bitset_words_contains_all(const u64* words, const u64* mask, u64 word_count)
+{
+#if BITSET_X86
+    if (take_avx2(word_count))
+    {
+        return contains_all_avx2(words, mask, word_count);
+    }
+#endif
+    for (u64 i = 0; i < word_count; ++i)
+    {
+        if (mask[i] & ~words[i])
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+b8 bitset_words_intersects(const u64* a, const u64* b, u64 word_count)
+{
+#if BITSET_X86
+    if (take_avx2(word_count))
+    {
+        return intersects_avx2(a, b, word_count);
+    }
+#endif
+    for (u64 i = 0; i < word_count; ++i)
+    {
+        if (a[i] & b[i])
+        {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+b8 bitset_words_none(const u64* words, u64 word_count)
+{
+    return !bitset_words_intersects(words, words, word_count);
+}
+
+static u64 padded_word_count(u64 bit_count)
+{
+    u64 word_count = bitset_word_count(bit_count);
+    return (word_count + BITSET_VECTOR_WORDS - 1) & ~(u64)(BITSET_VECTOR_WORDS - 1);
+}
+
+b8 _bitset_create(u64 bit_count, memory_tag tag, bitset* out_set, const char* file, u32 line)
+{
+    if (!out_set)
+    {
+        AERROR("bitset_create requires a valid pointer to a bitset.");
+        return FALSE;
+    }
+
+    azero_memory(out_set, sizeof(bitset));
+    out_set->tag = tag;
+    out_set->file = file;
+    out_set->line = line;
+    return bitset_resize(out_set, bit_count);
+}
+
+void bitset_destroy(bitset* set)
+{
+    if (set->words)
+    {
+        afree_aligned(set->words, set->word_count * sizeof(u64), BITSET_VECTOR_ALIGNMENT, set->tag);
+    }
+    azero_memory(set, sizeof(bitset));
+}
+
+// Clear the bits past bit_count in the last word, which operations such as set_all and
+// shrinking leave behind.
+static void clear_tail_bits(bitset* set)
+{
+    u64 used_words = bitset_word_count(set->bit_count);
+    if (set->bit_count % BITSET_WORD_BITS)
+    {
+        set->words[used_words - 1] &= ~0ULL >> (BITSET_WORD_BITS - set->bit_count % BITSET_WORD_BITS);
+    }
+    if (used_words < set->word_count)
+    {
+        azero_memory(set->words + used_words, (set->word_count - used_words) * sizeof(u64));
+    }
+}
+
+b8 bitset_resize(bitset* set, u64 bit_count)
+{
+    u64 word_count = padded_word_count(bit_count);
+    if (word_count != set->word_count)
+    {
+        u64* words = 0;
+        if (word_count)
+        {
+            // Aligned blocks come zeroed, so the added bits start clear.
+            words = _aallocate_aligned(word_count * sizeof(u64), BITSET_VECTOR_ALIGNMENT, set->tag, set->file, set->line);
+            if (!words)
+            {
+                AERROR("bitset_resize - Failed to allocate %llu bits.", bit_count);
+                return FALSE;
+            }
+        }
+
+        if (set->words)
+        {
+            if (words)
+            {
+                acopy_memory(words, set->words, (word_count < set->word_count ? word_count : set->word_count) * sizeof(u64));
+            }
+            afree_aligned(set->words, set->word_count * sizeof(u64), BITSET_VECTOR_ALIGNMENT, set->tag);
+        }
+        set->words = words;
+        set->word_count = word_count;
+    }
+
+    set->bit_count = bit_count;
+    if (word_count)
+    {
+        clear_tail_bits(set);
+    }
+    return TRUE;
+}
+
+void bitset_set_all(bitset* set)
+{
+    if (set->word_count)
+    {
+        aset_memory(set->words, 0xFF, set->word_count * sizeof(u64));
+        clear_tail_bits(set);
+    }
+}
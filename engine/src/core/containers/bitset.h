@@ -0,0 +1,347 @@
+#pragma once
+
+#include "defines.h"
+#include "core/amemory.h"
+
+// Bitsets pack one flag per bit in u64 words, so 256 flags fit in half a cache line and
+// whole masks combine a word, or with AVX2 four words, at a time.
+//
+// Fixed-size bitsets are structs declared with bitset_define, copied and stored by value, for
+// masks of a known size such as key states and component masks. Dynamic bitsets own their
+// words on the heap, for masks sized at runtime such as one bit per entity.
+//
+// Both are word arrays underneath. Fixed-size operations are inlined; dynamic ones go through
+// the bitset_words_ functions, which take the AVX2 path from BITSET_SIMD_MIN_WORDS words on
+// CPUs supporting it.
+
+#define BITSET_WORD_BITS 64
+
+// Spans at least this many words long take the AVX2 path, shorter ones the scalar loop.
+#define BITSET_SIMD_MIN_WORDS 4
+
+// Returned by bitset_words_next when no set bit is left.
+#define BITSET_NOT_FOUND 0xFFFFFFFFFFFFFFFFULL
+
+// The number of words holding bit_count bits.
+#define bitset_word_count(bit_count) \
+    (((bit_count) + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS)
+
+#define bitset_words_set(words, bit) \
+    ((words)[(bit) / BITSET_WORD_BITS] |= 1ULL << ((bit) % BITSET_WORD_BITS))
+
+#define bitset_words_clear(words, bit) \
+    ((words)[(bit) / BITSET_WORD_BITS] &= ~(1ULL << ((bit) % BITSET_WORD_BITS)))
+
+// TRUE if the bit is set.
+#define bitset_words_test(words, bit) \
+    ((b8)(((words)[(bit) / BITSET_WORD_BITS] >> ((bit) % BITSET_WORD_BITS)) & 1))
+
+/**
+ * Intersect a span of words with another: dest &= source.
+ * @param dest A pointer to the words to update.
+ * @param source A pointer to the words to combine.
+ * @param word_count The number of words.
+ */
+AAPI void bitset_words_and(u64* dest, const u64* source, u64 word_count);
+
+/**
+ * Unite a span of words with another: dest |= source.
+ * @param dest A pointer to the words to update.
+ * @param source A pointer to the words to combine.
+ * @param word_count The number of words.
+ */
+AAPI void bitset_words_or(u64* dest, const u64* source, u64 word_count);
+
+/**
+ * Clear the bits of a span of words set in another: dest &= ~source.
+ * @param dest A pointer to the words to update.
+ * @param source A pointer to the words to combine.
+ * @param word_count The number of words.
+ */
+AAPI void bitset_words_andnot(u64* dest, const u64* source, u64 word_count);
+
+/**
+ * Flip the bits of a span of words set in another: dest ^= source. Applied to the current and
+ * previous states, leaves the bits that changed.
+ * @param dest A pointer to the words to update.
+ * @param source A pointer to the words to combine.
+ * @param word_count The number of words.
+ */
+AAPI void bitset_words_xor(u64* dest, const u64* source, u64 word_count);
+
+/**
+ * Count the set bits of a span of words.
+ * @param words A pointer to the words.
+ * @param word_count The number of words.
+ * @return The number of set bits.
+ */
+AAPI u64 bitset_words_count(const u64* words, u64 word_count);
+
+/**
+ * Check whether a span of words holds every bit of a mask, as component queries do.
+ * @param words A pointer to the words.
+ * @param mask A pointer to the mask words.
+ * @param word_count The number of words.
+ * @return TRUE if (words & mask) == mask; otherwise FALSE.
+ */
+AAPI b8 bitset_words_contains_all(const u64* words, const u64* mask, u64 word_count);
+
+/**
+ * Check whether a span of words shares any bit with another.
+ * @param a A pointer to the first words.
+ * @param b A pointer to the second words.
+ * @param word_count The number of words.
+ * @return TRUE if (a & b) != 0; otherwise FALSE.
+ */
+AAPI b8 bitset_words_intersects(const u64* a, const u64* b, u64 word_count);
+
+/**
+ * Check whether a span of words has no set bit.
+ * @param words A pointer to the words.
+ * @param word_count The number of words.
+ * @return TRUE if every bit is clear; otherwise FALSE.
+ */
+AAPI b8 bitset_words_none(const u64* words, u64 word_count);
+
+/**
+ * Find the first set bit at or after a position, skipping clear words whole.
+ * @param words A pointer to the words.
+ * @param word_count The number of words.
+ * @param from The position to search from.
+ * @return The index of the bit, or BITSET_NOT_FOUND if no bit from that position is set.
+ */
+static inline u64 bitset_words_next(const u64* words, u64 word_count, u64 from)
+{
+    u64 index = from / BITSET_WORD_BITS;
+    if (index >= word_count)
+    {
+        return BITSET_NOT_FOUND;
+    }
+
+    // Drop the bits before the position in the first word.
+    u64 word = words[index] & (~0ULL << (from % BITSET_WORD_BITS));
+    while (!word)
+    {
+        if (++index == word_count)
+        {
+            return BITSET_NOT_FOUND;
+        }
+        word = words[index];
+    }
+
+    return index * BITSET_WORD_BITS + (u64)__builtin_ctzll(word);
+}
+
+// Iterate the set bits of a span of words in increasing order, declaring bit as a u64.
+#define bitset_words_for_each(words, word_count, bit)                     \
+    for (u64 bit = bitset_words_next((words), (word_count), 0);           \
+         bit != BITSET_NOT_FOUND;                                         \
+         bit = bitset_words_next((words), (word_count), bit + 1))
+
+// Declare a fixed-size bitset type holding bit_count bits.
+#define bitset_define(name, bit_count)             \
+    typedef struct name                            \
+    {                                              \
+        u64 words[bitset_word_count(bit_count)];   \
+    } name
+
+bitset_define(bitset64, 64);
+bitset_define(bitset128, 128);
+bitset_define(bitset256, 256);
+
+// The fixed-size operations are inlined scalar loops: up to 256 bits, a call into the AVX2
+// kernels costs more than the work itself.
+
+static inline void _bitset_fixed_and(u64* dest, const u64* source, u64 word_count)
+{
+    for (u64 i = 0; i < word_count; ++i)
+    {
+        dest[i] &= source[i];
+    }
+}
+
+static inline void _bitset_fixed_or(u64* dest, const u64* source, u64 word_count)
+{
+    for (u64 i = 0; i < word_count; ++i)
+    {
+        dest[i] |= source[i];
+    }
+}
+
+static inline void _bitset_fixed_andnot(u64* dest, const u64* source, u64 word_count)
+{
+    for (u64 i = 0; i < word_count; ++i)
+    {
+        dest[i] &= ~source[i];
+    }
+}
+
+static inline void _bitset_fixed_xor(u64* dest, const u64* source, u64 word_count)
+{
+    for (u64 i = 0; i < word_count; ++i)
+    {
+        dest[i] ^= source[i];
+    }
+}
+
+static inline u64 _bitset_fixed_count(const u64* words, u64 word_count)
+{
+    u64 result = 0;
+    for (u64 i = 0; i < word_count; ++i)
+    {
+        result += (u64)__builtin_popcountll(words[i]);
+    }
+    return result;
+}
+
+static inline b8 _bitset_fixed_contains_all(const u64* words, const u64* mask, u64 word_count)
+{
+    u64 missing = 0;
+    for (u64 i = 0; i < word_count; ++i)
+    {
+        missing |= mask[i] & ~words[i];
+    }
+    return missing == 0;
+}
+
+static inline b8 _bitset_fixed_intersects(const u64* a, const u64* b, u64 word_count)
+{
+    u64 common = 0;
+    for (u64 i = 0; i < word_count; ++i)
+    {
+        common |= a[i] & b[i];
+    }
+    return common != 0;
+}
+
+// Fixed-size bitsets are passed by pointer and start cleared when zero-initialized.
+
+#define bitset_fixed_word_count(set) \
+    (sizeof((set)->words) / sizeof(u64))
+
+#define bitset_fixed_set(set, bit) \
+    bitset_words_set((set)->words, bit)
+
+#define bitset_fixed_clear(set, bit) \
+    bitset_words_clear((set)->words, bit)
+
+#define bitset_fixed_test(set, bit) \
+    bitset_words_test((set)->words, bit)
+
+#define bitset_fixed_clear_all(set) \
+    azero_memory((set)->words, sizeof((set)->words))
+
+#define bitset_fixed_and(dest, source) \
+    _bitset_fixed_and((dest)->words, (source)->words, bitset_fixed_word_count(dest))
+
+#define bitset_fixed_or(dest, source) \
+    _bitset_fixed_or((dest)->words, (source)->words, bitset_fixed_word_count(dest))
+
+#define bitset_fixed_andnot(dest, source) \
+    _bitset_fixed_andnot((dest)->words, (source)->words, bitset_fixed_word_count(dest))
+
+#define bitset_fixed_xor(dest, source) \
+    _bitset_fixed_xor((dest)->words, (source)->words, bitset_fixed_word_count(dest))
+
+#define bitset_fixed_count(set) \
+    _bitset_fixed_count((set)->words, bitset_fixed_word_count(set))
+
+#define bitset_fixed_contains_all(set, mask) \
+    _bitset_fixed_contains_all((set)->words, (mask)->words, bitset_fixed_word_count(set))
+
+#define bitset_fixed_intersects(a, b) \
+    _bitset_fixed_intersects((a)->words, (b)->words, bitset_fixed_word_count(a))
+
+#define bitset_fixed_none(set) \
+    (!_bitset_fixed_intersects((set)->words, (set)->words, bitset_fixed_word_count(set)))
+
+#define bitset_fixed_for_each(set, bit) \
+    bitset_words_for_each((set)->words, bitset_fixed_word_count(set), bit)
+
+typedef struct bitset
+{
+    // The words, padded to a whole number of AVX2 vectors. Bits past bit_count stay clear.
+    u64* words;
+    u64 word_count;
+    u64 bit_count;
+    memory_tag tag;
+    // The call site that created the bitset, to report its words under.
+    const char* file;
+    u32 line;
+} bitset;
+
+/**
+ * Create a dynamic bitset with every bit clear.
+ * @param bit_count The number of bits.
+ * @param tag The tag to account the words under, such as MEMORY_TAG_ENTITY.
+ * @param out_set A pointer to the bitset to initialize.
+ * @return TRUE on success; otherwise FALSE.
+ */
+#define bitset_create(bit_count, tag, out_set) \
+    _bitset_create(bit_count, tag, out_set, __FILE__, __LINE__)
+
+AAPI b8 _bitset_create(u64 bit_count, memory_tag tag, bitset* out_set, const char* file, u32 line);
+
+/**
+ * Destroy a dynamic bitset.
+ * @param set A pointer to the bitset.
+ */
+AAPI void bitset_destroy(bitset* set);
+
+/**
+ * Grow or shrink a dynamic bitset. Bits added are clear.
+ * @param set A pointer to the bitset.
+ * @param bit_count The new number of bits.
+ * @return TRUE on success; FALSE on allocation failure, leaving the bitset unchanged.
+ */
+AAPI b8 bitset_resize(bitset* set, u64 bit_count);
+
+/**
+ * Set every bit of a dynamic bitset.
+ * @param set A pointer to the bitset.
+ */
+AAPI void bitset_set_all(bitset* set);
+
+// The operations between dynamic bitsets combine as many words as the smaller one holds;
+// the bits of the larger one past those are left as is and ignored.
+#define bitset_common_word_count(a, b) \
+    ((a)->word_count < (b)->word_count ? (a)->word_count : (b)->word_count)
+
+#define bitset_set(set, bit) \
+    bitset_words_set((set)->words, bit)
+
+#define bitset_clear(set, bit) \
+    bitset_words_clear((set)->words, bit)
+
+#define bitset_test(set, bit) \
+    bitset_words_test((set)->words, bit)
+
+#define bitset_clear_all(set) \
+    azero_memory((set)->words, (set)->word_count * sizeof(u64))
+
+#define bitset_and(dest, source) \
+    bitset_words_and((dest)->words, (source)->words, bitset_common_word_count(dest, source))
+
+#define bitset_or(dest, source) \
+    bitset_words_or((dest)->words, (source)->words, bitset_common_word_count(dest, source))
+
+#define bitset_andnot(dest, source) \
+    bitset_words_andnot((dest)->words, (source)->words, bitset_common_word_count(dest, source))
+
+#define bitset_xor(dest, source) \
+    bitset_words_xor((dest)->words, (source)->words, bitset_common_word_count(dest, source))
+
+#define bitset_count(set) \
+    bitset_words_count((set)->words, (set)->word_count)
+
+#define bitset_contains_all(set, mask) \
+    bitset_words_contains_all((set)->words, (mask)->words, bitset_common_word_count(set, mask))
+
+#define bitset_intersects(a, b) \
+    bitset_words_intersects((a)->words, (b)->words, bitset_common_word_count(a, b))
+
+#define bitset_none(set) \
+    bitset_words_none((set)->words, (set)->word_count)
+
+#define bitset_for_each(set, bit) \
+    bitset_words_for_each((set)->words, (set)->word_count, bit)
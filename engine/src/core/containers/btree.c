@@ -0,0 +1,658 @@
+#include "btree.h"
+
+#include "core/logger.h"
+#include "core/amemory.h"
+#include "core/memory/simd_memory.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BTREE_X86 1
+#include <immintrin.h>
+#else
+#define BTREE_X86 0
+#endif
+
+STATIC_ASSERT(sizeof(btree_leaf) <= BTREE_NODE_SIZE, "Expected a btree leaf to fit in BTREE_NODE_SIZE.");
+STATIC_ASSERT(sizeof(btree_inner) <= BTREE_NODE_SIZE, "Expected a btree inner node to fit in BTREE_NODE_SIZE.");
+
+// Nodes other than the root never hold fewer keys.
+#define BTREE_MIN_KEYS (BTREE_MAX_KEYS / 2)
+
+// Deep enough for 2^64 keys with half-full nodes.
+#define BTREE_MAX_HEIGHT 16
+
+// The nodes are allocated this many at a time.
+#define BTREE_NODES_PER_BLOCK 64
+
+static b8 use_avx2 = FALSE;
+
+// The number of keys of a node less than key. Keys past the count are padding and never count.
+static u32 count_less_scalar(const u64* keys, u32 count, u64 key)
+{
+    u32 result = 0;
+    for (u32 i = 0; i < count; ++i)
+    {
+        result += keys[i] < key;
+    }
+    return result;
+}
+
+#if BTREE_X86
+__attribute__((target("avx2"))) static u32 count_less_avx2(const u64* keys, u32 count, u64 key)
+{
+    // AVX2 only compares signed 64-bit integers, flipping the sign bits orders them as unsigned.
+    const __m256i bias = _mm256_set1_epi64x((i64)0x8000000000000000ULL);
+    __m256i biased_key = _mm256_xor_si256(_mm256_set1_epi64x((i64)key), bias);
+    __m256i total = _mm256_setzero_si256();
+    for (u32 i = 0; i < count; i += 4)
+    {
+        __m256i biased_keys = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(keys + i)), bias);
+        // Lanes less than the key are -1, subtracting them counts them.
+        total = _mm256_sub_epi64(total, _mm256_cmpgt_epi64(biased_key, biased_keys));
+    }
+
+    __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+    return (u32)(_mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1));
+}
+#endif
+
+static inline u32 count_less(const u64* keys, u32 count, u64 key)
+{
+#if BTREE_X86
+    if (use_avx2)
+    {
+        return count_less_avx2(keys, count, key);
+    }
+#endif
+    return count_less_scalar(keys, count, key);
+}
+
+// The child of an inner node whose subtree may hold key.
+static inline u32 child_index(const btree_inner* inner, u64 key)
+{
+    return key == BTREE_KEY_PADDING ? inner->count : count_less(inner->keys, inner->count, key + 1);
+}
+
+static void pad_keys(u64* keys, u32 count)
+{
+    for (u32 i = count; i < BTREE_KEY_SLOTS; ++i)
+    {
+        keys[i] = BTREE_KEY_PADDING;
+    }
+}
+
+static btree_leaf* leaf_create(btree* tree)
+{
+    btree_leaf* leaf = pool_allocator_allocate(&tree->nodes);
+    if (leaf)
+    {
+        leaf->count = 0;
+        leaf->next = 0;
+        pad_keys(leaf->keys, 0);
+    }
+    return leaf;
+}
+
+static btree_inner* inner_create(btree* tree)
+{
+    btree_inner* inner = pool_allocator_allocate(&tree->nodes);
+    if (inner)
+    {
+        inner->count = 0;
+        pad_keys(inner->keys, 0);
+    }
+    return inner;
+}
+
+b8 _btree_create(btree* out_tree, const char* file, u32 line)
+{
+    if (!out_tree)
+    {
+        AERROR("btree_create requires a valid pointer to a tree.");
+        return FALSE;
+    }
+
+    azero_memory(out_tree, sizeof(btree));
+    _pool_allocator_create(BTREE_NODE_SIZE, BTREE_NODES_PER_BLOCK, MEMORY_TAG_BST, &out_tree->nodes, file, line);
+    use_avx2 = simd_cpu_has_avx2();
+    return TRUE;
+}
+
+// Return a subtree to the pool, so destroying the pool doesn't report the nodes as leaked.
+static void free_subtree(btree* tree, void* node, u32 height)
+{
+    if (height > 0)
+    {
+        btree_inner* inner = node;
+        for (u32 i = 0; i <= inner->count; ++i)
+        {
+            free_subtree(tree, inner->children[i], height - 1);
+        }
+    }
+    pool_allocator_free(&tree->nodes, node);
+}
+
+void btree_destroy(btree* tree)
+{
+    if (tree->root)
+    {
+        free_subtree(tree, tree->root, tree->height);
+    }
+    pool_allocator_destroy(&tree->nodes);
+    azero_memory(tree, sizeof(btree));
+}
+
+// The path from the root to a leaf: each inner node and the index of the child taken.
+typedef struct btree_path
+{
+    btree_inner* nodes[BTREE_MAX_HEIGHT];
+    u32 indices[BTREE_MAX_HEIGHT];
+} btree_path;
+
+static btree_leaf* find_leaf(const btree* tree, u64 key, btree_path* out_path)
+{
+    void* node = tree->root;
+    for (u32 level = 0; level < tree->height; ++level)
+    {
+        btree_inner* inner = node;
+        u32 index = child_index(inner, key);
+        if (out_path)
+        {
+            out_path->nodes[level] = inner;
+            out_path->indices[level] = index;
+        }
+        node = inner->children[index];
+    }
+    return node;
+}
+
+b8 btree_find(const btree* tree, u64 key, u64* out_value)
+{
+    if (!tree->root)
+    {
+        return FALSE;
+    }
+
+    btree_leaf* leaf = find_leaf(tree, key, 0);
+    u32 index = count_less(leaf->keys, leaf->count, key);
+    if (index == leaf->count || leaf->keys[index] != key)
+    {
+        return FALSE;
+    }
+
+    if (out_value)
+    {
+        *out_value = leaf->values[index];
+    }
+    return TRUE;
+}
+
+static void leaf_insert_at(btree_leaf* leaf, u32 index, u64 key, u64 value)
+{
+    u32 moved = leaf->count - index;
+    amove_memory(&leaf->keys[index + 1], &leaf->keys[index], moved * sizeof(u64));
+    amove_memory(&leaf->values[index + 1], &leaf->values[index], moved * sizeof(u64));
+    leaf->keys[index] = key;
+    leaf->values[index] = value;
+    leaf->count++;
+}
+
+// Insert a key and the child to its right.
+static void inner_insert_at(btree_inner* inner, u32 index, u64 key, void* right_child)
+{
+    u32 moved = inner->count - index;
+    amove_memory(&inner->keys[index + 1], &inner->keys[index], moved * sizeof(u64));
+    amove_memory(&inner->children[index + 2], &inner->children[index + 1], moved * sizeof(void*));
+    inner->keys[index] = key;
+    inner->children[index + 1] = right_child;
+    inner->count++;
+}
+
+// Insert a separator and the node to its right in the parents of the path, splitting the
+// full ones on the way up. The new inner nodes are taken from spares, one per full parent and
+// one more if the root splits.
+static void insert_in_parents(btree* tree, btree_path* path, u32 level, u64 separator, void* right, btree_inner** spares)
+{
+    while (level > 0)
+    {
+        level--;
+        btree_inner* inner = path->nodes[level];
+        u32 index = path->indices[level];
+        if (inner->count < BTREE_MAX_KEYS)
+        {
+            inner_insert_at(inner, index, separator, right);
+            return;
+        }
+
+        btree_inner* sibling = *spares++;
+
+        // Lay out the keys and children with the new ones, then split them around the middle
+        // key, which moves up.
+        u64 keys[BTREE_MAX_KEYS + 1];
+        void* children[BTREE_MAX_KEYS + 2];
+        acopy_memory(keys, inner->keys, index * sizeof(u64));
+        keys[index] = separator;
+        acopy_memory(&keys[index + 1], &inner->keys[index], (BTREE_MAX_KEYS - index) * sizeof(u64));
+        acopy_memory(children, inner->children, (index + 1) * sizeof(void*));
+        children[index + 1] = right;
+        acopy_memory(&children[index + 2], &inner->children[index + 1], (BTREE_MAX_KEYS - index) * sizeof(void*));
+
+        u32 left_count = (BTREE_MAX_KEYS + 1) / 2;
+        u32 right_count = BTREE_MAX_KEYS - left_count;
+        acopy_memory(inner->keys, keys, left_count * sizeof(u64));
+        acopy_memory(inner->children, children, (left_count + 1) * sizeof(void*));
+        inner->count = left_count;
+        pad_keys(inner->keys, left_count);
+
+        acopy_memory(sibling->keys, &keys[left_count + 1], right_count * sizeof(u64));
+        acopy_memory(sibling->children, &children[left_count + 1], (right_count + 1) * sizeof(void*));
+        sibling->count = right_count;
+
+        separator = keys[left_count];
+        right = sibling;
+    }
+
+    // The root split, grow the tree by a level.
+    btree_inner* root = *spares;
+    root->children[0] = tree->root;
+    root->children[1] = right;
+    root->keys[0] = separator;
+    root->count = 1;
+    tree->root = root;
+    tree->height++;
+}
+
+b8 btree_insert(btree* tree, u64 key, u64 value)
+{
+    if (!tree->root)
+    {
+        btree_leaf* leaf = leaf_create(tree);
+        if (!leaf)
+        {
+            return FALSE;
+        }
+        tree->root = leaf;
+        tree->first_leaf = leaf;
+    }
+
+    btree_path path;
+    btree_leaf* leaf = find_leaf(tree, key, &path);
+    u32 index = count_less(leaf->keys, leaf->count, key);
+    if (index < leaf->count && leaf->keys[index] == key)
+    {
+        leaf->values[index] = value;
+        return TRUE;
+    }
+
+    if (leaf->count < BTREE_MAX_KEYS)
+    {
+        leaf_insert_at(leaf, index, key, value);
+        tree->count++;
+        return TRUE;
+    }
+
+    // The split goes up through every full parent, and grows the tree if they all are.
+    u32 split_count = 0;
+    while (split_count < tree->height && path.nodes[tree->height - 1 - split_count]->count == BTREE_MAX_KEYS)
+    {
+        split_count++;
+    }
+    u32 inner_count = split_count == tree->height ? split_count + 1 : split_count;
+    if (split_count == tree->height && tree->height + 1 >= BTREE_MAX_HEIGHT)
+    {
+        AERROR("btree - The tree is too deep.");
+        return FALSE;
+    }
+
+    // Allocate every node the split needs first, so nothing changes if the pool can't grow.
+    btree_leaf* sibling = leaf_create(tree);
+    btree_inner* spares[BTREE_MAX_HEIGHT];
+    u32 spare_count = 0;
+    while (sibling && spare_count < inner_count && (spares[spare_count] = inner_create(tree)))
+    {
+        spare_count++;
+    }
+    if (spare_count < inner_count || !sibling)
+    {
+        for (u32 i = 0; i < spare_count; ++i)
+        {
+            pool_allocator_free(&tree->nodes, spares[i]);
+        }
+        if (sibling)
+        {
+            pool_allocator_free(&tree->nodes, sibling);
+        }
+        return FALSE;
+    }
+
+    // Split the full leaf in halves and insert in the right one.
+
+    u32 left_count = BTREE_MAX_KEYS / 2;
+    sibling->count = BTREE_MAX_KEYS - left_count;
+    acopy_memory(sibling->keys, &leaf->keys[left_count], sibling->count * sizeof(u64));
+    acopy_memory(sibling->values, &leaf->values[left_count], sibling->count * sizeof(u64));
+    leaf->count = left_count;
+    pad_keys(leaf->keys, left_count);
+    sibling->next = leaf->next;
+    leaf->next = sibling;
+
+    if (index <= left_count)
+    {
+        leaf_insert_at(leaf, index, key, value);
+    }
+    else
+    {
+        leaf_insert_at(sibling, index - left_count, key, value);
+    }
+    tree->count++;
+
+    insert_in_parents(tree, &path, tree->height, sibling->keys[0], sibling, spares);
+    return TRUE;
+}
+
+static void leaf_remove_at(btree_leaf* leaf, u32 index)
+{
+    u32 moved = leaf->count - index - 1;
+    amove_memory(&leaf->keys[index], &leaf->keys[index + 1], moved * sizeof(u64));
+    amove_memory(&leaf->values[index], &leaf->values[index + 1], moved * sizeof(u64));
+    leaf->count--;
+    leaf->keys[leaf->count] = BTREE_KEY_PADDING;
+}
+
+// Remove a key and the child to its right.
+static void inner_remove_at(btree_inner* inner, u32 index)
+{
+    u32 moved = inner->count - index - 1;
+    amove_memory(&inner->keys[index], &inner->keys[index + 1], moved * sizeof(u64));
+    amove_memory(&inner->children[index + 1], &inner->children[index + 2], moved * sizeof(void*));
+    inner->count--;
+    inner->keys[inner->count] = BTREE_KEY_PADDING;
+}
+
+// Refill a leaf left with too few keys from a sibling, or merge it with one.
+// Returns TRUE if the parent lost a key.
+static b8 rebalance_leaf(btree* tree, btree_leaf* leaf, btree_inner* parent, u32 index)
+{
+    btree_leaf* left = index > 0 ? parent->children[index - 1] : 0;
+    btree_leaf* right = index < parent->count ? parent->children[index + 1] : 0;
+
+    if (left && left->count > BTREE_MIN_KEYS)
+    {
+        leaf_insert_at(leaf, 0, left->keys[left->count - 1], left->values[left->count - 1]);
+        leaf_remove_at(left, left->count - 1);
+        parent->keys[index - 1] = leaf->keys[0];
+        return FALSE;
+    }
+    if (right && right->count > BTREE_MIN_KEYS)
+    {
+        leaf_insert_at(leaf, leaf->count, right->keys[0], right->values[0]);
+        leaf_remove_at(right, 0);
+        parent->keys[index] = right->keys[0];
+        return FALSE;
+    }
+
+    // Merge into the left node of the pair, so the first leaf never goes away.
+    if (!left)
+    {
+        left = leaf;
+        leaf = right;
+        index++;
+    }
+    acopy_memory(&left->keys[left->count], leaf->keys, leaf->count * sizeof(u64));
+    acopy_memory(&left->values[left->count], leaf->values, leaf->count * sizeof(u64));
+    left->count += leaf->count;
+    left->next = leaf->next;
+    pool_allocator_free(&tree->nodes, leaf);
+    inner_remove_at(parent, index - 1);
+    return TRUE;
+}
+
+// Refill an inner node left with too few keys from a sibling, rotating keys through the
+// parent, or merge it with one. Returns TRUE if the parent lost a key.
+static b8 rebalance_inner(btree* tree, btree_inner* inner, btree_inner* parent, u32 index)
+{
+    btree_inner* left = index > 0 ? parent->children[index - 1] : 0;
+    btree_inner* right = index < parent->count ? parent->children[index + 1] : 0;
+
+    if (left && left->count > BTREE_MIN_KEYS)
+    {
+        amove_memory(&inner->keys[1], inner->keys, inner->count * sizeof(u64));
+        amove_memory(&inner->children[1], inner->children, (inner->count + 1) * sizeof(void*));
+        inner->keys[0] = parent->keys[index - 1];
+        inner->children[0] = left->children[left->count];
+        inner->count++;
+        parent->keys[index - 1] = left->keys[left->count - 1];
+        left->count--;
+        left->keys[left->count] = BTREE_KEY_PADDING;
+        return FALSE;
+    }
+    if (right && right->count > BTREE_MIN_KEYS)
+    {
+        inner->keys[inner->count] = parent->keys[index];
+        inner->children[inner->count + 1] = right->children[0];
+        inner->count++;
+        parent->keys[index] = right->keys[0];
+        amove_memory(right->keys, &right->keys[1], (right->count - 1) * sizeof(u64));
+        amove_memory(right->children, &right->children[1], right->count * sizeof(void*));
+        right->count--;
+        right->keys[right->count] = BTREE_KEY_PADDING;
+        return FALSE;
+    }
+
+    if (!left)
+    {
+        left = inner;
+        inner = right;
+        index++;
+    }
+    // The separator comes down between the keys of the pair.
+    left->keys[left->count] = parent->keys[index - 1];
+    acopy_memory(&left->keys[left->count + 1], inner->keys, inner->count * sizeof(u64));
+    acopy_memory(&left->children[left->count + 1], inner->children, (inner->count + 1) * sizeof(void*));
+    left->count += inner->count + 1;
+    pool_allocator_free(&tree->nodes, inner);
+    inner_remove_at(parent, index - 1);
+    return TRUE;
+}
+
+b8 btree_remove(btree* tree, u64 key, u64* out_value)
+{
+    if (!tree->root)
+    {
+        return FALSE;
+    }
+
+    btree_path path;
+    btree_leaf* leaf = find_leaf(tree, key, &path);
+    u32 index = count_less(leaf->keys, leaf->count, key);
+    if (index == leaf->count || leaf->keys[index] != key)
+    {
+        return FALSE;
+    }
+
+    if (out_value)
+    {
+        *out_value = leaf->values[index];
+    }
+    leaf_remove_at(leaf, index);
+    tree->count--;
+
+    // Separators equal to the removed key still route correctly, they are left as they are.
+    u32 level = tree->height;
+    if (level > 0 && leaf->count < BTREE_MIN_KEYS)
+    {
+        level--;
+        b8 shrunk = rebalance_leaf(tree, leaf, path.nodes[level], path.indices[level]);
+        while (shrunk && level > 0 && path.nodes[level]->count < BTREE_MIN_KEYS)
+        {
+            level--;
+            shrunk = rebalance_inner(tree, path.nodes[level + 1], path.nodes[level], path.indices[level]);
+        }
+    }
+
+    // Drop a root left with a single child, or an empty root leaf.
+    if (tree->height > 0 && ((btree_inner*)tree->root)->count == 0)
+    {
+        btree_inner* root = tree->root;
+        tree->root = root->children[0];
+        tree->height--;
+        pool_allocator_free(&tree->nodes, root);
+    }
+    else if (tree->height == 0 && tree->count == 0)
+    {
+        pool_allocator_free(&tree->nodes, tree->root);
+        tree->root = 0;
+        tree->first_leaf = 0;
+    }
+
+    return TRUE;
+}
+
+b8 btree_bulk_load(btree* tree, const sort_pair_u64* pairs, u64 count)
+{
+    for (u64 i = 1; i < count; ++i)
+    {
+        if (pairs[i].key <= pairs[i - 1].key)
+        {
+            AERROR("btree_bulk_load - The keys must be strictly increasing, the key of pair %llu isn't.", i);
+            return FALSE;
+        }
+    }
+
+    // Start over empty, keeping the call site the tree reports its nodes under.
+    const char* file = tree->nodes.file;
+    u32 line = tree->nodes.line;
+    btree_destroy(tree);
+    _btree_create(tree, file, line);
+    if (count == 0)
+    {
+        return TRUE;
+    }
+
+    // Spread the entries evenly over as few leaves as possible, so every leaf is at least
+    // half full. Each level keeps its nodes and their smallest keys for the level above.
+    u64 node_count = (count + BTREE_MAX_KEYS - 1) / BTREE_MAX_KEYS;
+    void** nodes = aallocate_uninit(node_count * sizeof(void*), MEMORY_TAG_BST);
+    u64* first_keys = aallocate_uninit(node_count * sizeof(u64), MEMORY_TAG_BST);
+    u64 allocated_count = node_count;
+    b8 result = TRUE;
+    if (!nodes || !first_keys)
+    {
+        result = FALSE;
+        goto cleanup;
+    }
+
+    btree_leaf* previous = 0;
+    u64 consumed = 0;
+    for (u64 i = 0; i < node_count; ++i)
+    {
+        btree_leaf* leaf = leaf_create(tree);
+        if (!leaf)
+        {
+            result = FALSE;
+            goto cleanup;
+        }
+
+        u32 leaf_count = (u32)((count * (i + 1)) / node_count - consumed);
+        for (u32 j = 0; j < leaf_count; ++j)
+        {
+            leaf->keys[j] = pairs[consumed + j].key;
+            leaf->values[j] = pairs[consumed + j].value;
+        }
+        leaf->count = leaf_count;
+        consumed += leaf_count;
+
+        if (previous)
+        {
+            previous->next = leaf;
+        }
+        else
+        {
+            tree->first_leaf = leaf;
+        }
+        previous = leaf;
+        nodes[i] = leaf;
+        first_keys[i] = leaf->keys[0];
+    }
+    tree->count = count;
+
+    // Build the inner levels over the level below, until a single node is left.
+    while (node_count > 1)
+    {
+        u64 child_count = node_count;
+        node_count = (child_count + BTREE_MAX_KEYS) / (BTREE_MAX_KEYS + 1);
+        u64 taken = 0;
+        for (u64 i = 0; i < node_count; ++i)
+        {
+            btree_inner* inner = inner_create(tree);
+            if (!inner)
+            {
+                result = FALSE;
+                goto cleanup;
+            }
+
+            u32 children = (u32)((child_count * (i + 1)) / node_count - taken);
+            for (u32 j = 0; j < children; ++j)
+            {
+                inner->children[j] = nodes[taken + j];
+                if (j > 0)
+                {
+                    inner->keys[j - 1] = first_keys[taken + j];
+                }
+            }
+            inner->count = children - 1;
+
+            // Nodes are rewritten in place, a node's slot is always read before it's written.
+            u64 first_key = first_keys[taken];
+            nodes[i] = inner;
+            first_keys[i] = first_key;
+            taken += children;
+        }
+        tree->height++;
+    }
+    tree->root = nodes[0];
+
+cleanup:
+    if (nodes)
+    {
+        afree(nodes, allocated_count * sizeof(void*), MEMORY_TAG_BST);
+    }
+    if (first_keys)
+    {
+        afree(first_keys, allocated_count * sizeof(u64), MEMORY_TAG_BST);
+    }
+    if (!result)
+    {
+        AERROR("btree_bulk_load - Failed to allocate %llu entries.", count);
+        btree_destroy(tree);
+        _btree_create(tree, file, line);
+    }
+    return result;
+}
+
+btree_iterator btree_begin(const btree* tree)
+{
+    btree_iterator iterator = {tree->first_leaf, 0};
+    return iterator;
+}
+
+btree_iterator btree_lower_bound(const btree* tree, u64 key)
+{
+    btree_iterator iterator = {0, 0};
+    if (!tree->root)
+    {
+        return iterator;
+    }
+
+    btree_leaf* leaf = find_leaf(tree, key, 0);
+    u32 index = count_less(leaf->keys, leaf->count, key);
+    if (index == leaf->count)
+    {
+        // Every key of this leaf is smaller, the next leaf starts above the key.
+        leaf = leaf->next;
+        index = 0;
+    }
+
+    iterator.leaf = leaf;
+    iterator.index = index;
+    return iterator;
+}
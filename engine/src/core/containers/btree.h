@@ -0,0 +1,148 @@
+#pragma once
+
+#include "defines.h"
+#include "core/memory/pool_allocator.h"
+#include "core/containers/sort.h"
+
+// An ordered map from u64 keys to u64 values, stored as a B+tree.
+//
+// Nodes span BTREE_NODE_SIZE bytes, a few cache lines, so the tree stays shallow: a lookup
+// among millions of keys visits 4 or 5 nodes instead of 20 in a binary tree. Keys within a
+// node are searched with AVX2 when available. Entries live in the leaves, which are linked
+// in key order for range iteration. Nodes come from a pool under MEMORY_TAG_BST.
+
+#define BTREE_NODE_SIZE 512
+
+// The most keys held by a node. Nodes other than the root hold at least half as many.
+#define BTREE_MAX_KEYS 30
+
+// The key array of a node. Slots past the key count hold BTREE_KEY_PADDING, so searches can
+// scan whole vectors without masking.
+#define BTREE_KEY_SLOTS 32
+#define BTREE_KEY_PADDING 0xFFFFFFFFFFFFFFFFULL
+
+typedef struct btree_leaf
+{
+    u64 keys[BTREE_KEY_SLOTS];
+    u64 values[BTREE_MAX_KEYS];
+    u32 count;
+    // The leaf holding the next keys, 0/NULL for the last leaf.
+    struct btree_leaf* next;
+} btree_leaf;
+
+typedef struct btree_inner
+{
+    // keys[i] is the smallest key of the subtree in children[i + 1].
+    u64 keys[BTREE_KEY_SLOTS];
+    void* children[BTREE_MAX_KEYS + 1];
+    u32 count;
+} btree_inner;
+
+typedef struct btree
+{
+    // A btree_leaf if height is 0; otherwise a btree_inner. 0/NULL when the tree is empty.
+    void* root;
+    // The number of inner levels above the leaves.
+    u32 height;
+    // The number of entries.
+    u64 count;
+    btree_leaf* first_leaf;
+    pool_allocator nodes;
+} btree;
+
+// A position in the tree, valid until the next insertion or removal.
+typedef struct btree_iterator
+{
+    // 0/NULL past the last entry.
+    btree_leaf* leaf;
+    u32 index;
+} btree_iterator;
+
+/**
+ * Create an empty tree.
+ * @param out_tree A pointer to the tree to initialize.
+ * @return TRUE on success; otherwise FALSE.
+ */
+#define btree_create(out_tree) \
+    _btree_create(out_tree, __FILE__, __LINE__)
+
+AAPI b8 _btree_create(btree* out_tree, const char* file, u32 line);
+
+/**
+ * Destroy a tree, freeing every node.
+ * @param tree A pointer to the tree.
+ */
+AAPI void btree_destroy(btree* tree);
+
+/**
+ * Insert or overwrite the value of a key.
+ * @param tree A pointer to the tree.
+ * @param key The key.
+ * @return TRUE on success; otherwise FALSE, leaving the tree unchanged.
+ * @return TRUE on success; otherwise FALSE.
+ */
+AAPI b8 btree_insert(btree* tree, u64 key, u64 value);
+
+/**
+ * Find the value of a key.
+ * @param tree A pointer to the tree.
+ * @param key The key.
+ * @param out_value A pointer to copy the value to. May be 0/NULL.
+ * @return TRUE if the key was found; otherwise FALSE.
+ */
+AAPI b8 btree_find(const btree* tree, u64 key, u64* out_value);
+
+/**
+ * Remove a key, merging or rebalancing nodes left less than half full.
+ * @param tree A pointer to the tree.
+ * @param key The key.
+ * @param out_value A pointer to copy the value to before removing it. May be 0/NULL.
+ * @return TRUE if the key was removed; FALSE if it wasn't there.
+ */
+AAPI b8 btree_remove(btree* tree, u64 key, u64* out_value);
+
+/**
+ * Replace the contents of a tree with pairs sorted by key, building it bottom-up with full
+ * nodes. Much faster than inserting the pairs one by one.
+ * @param tree A pointer to the tree.
+ * @param pairs A pointer to the pairs, sorted by strictly increasing key, such as a darray
+ * sorted with darray_sort_radix.
+ * @param count The number of pairs.
+ * @return TRUE on success; FALSE if the keys aren't strictly increasing or on allocation failure.
+ */
+AAPI b8 btree_bulk_load(btree* tree, const sort_pair_u64* pairs, u64 count);
+
+/**
+ * Retrieve an iterator on the smallest key.
+ * @param tree A pointer to the tree.
+ * @return The iterator, past the end if the tree is empty.
+ */
+AAPI btree_iterator btree_begin(const btree* tree);
+
+/**
+ * Retrieve an iterator on the smallest key not less than the given key, to iterate a range.
+ * @param tree A pointer to the tree.
+ * @param key The key.
+ * @return The iterator, past the end if every key is less than the given key.
+ */
+AAPI btree_iterator btree_lower_bound(const btree* tree, u64 key);
+
+// TRUE if the iterator is on an entry.
+#define btree_iterator_valid(iterator) \
+    ((iterator)->leaf != 0)
+
+#define btree_iterator_key(iterator) \
+    ((iterator)->leaf->keys[(iterator)->index])
+
+#define btree_iterator_value(iterator) \
+    ((iterator)->leaf->values[(iterator)->index])
+
+// Move the iterator to the next key. Usable as the step of a for loop.
+static inline void btree_iterator_next(btree_iterator* iterator)
+{
+    if (++iterator->index >= iterator->leaf->count)
+    {
+        iterator->leaf = iterator->leaf->next;
+        iterator->index = 0;
+    }
+}
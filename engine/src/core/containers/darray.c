@@ -2,16 +2,142 @@
 
 #include "core/logger.h"
 #include "core/amemory.h"
+#include "core/memory/allocator.h"
 
-void *_darray_create(u64 length, u64 stride)
+#define DARRAY_HEADER_SIZE (DARRAY_FIELD_LENGTH * sizeof(u64))
+
+static darray_growth_policy growth_policy = DARRAY_GROWTH_DOUBLE;
+
+// Inline arrays grow by spilling to the general heap, leaving their storage to the caller.
+static void* inline_spill(void* state, void* block, u64 old_size, u64 new_size, memory_tag tag)
+{
+    void* new_block = aallocate_uninit(new_size, tag);
+    if (new_block)
+    {
+        acopy_memory(new_block, block, old_size < new_size ? old_size : new_size);
+    }
+
+    return new_block;
+}
+
+static void inline_free(void* state, void* block, u64 size, memory_tag tag)
+{
+}
+
+static allocator inline_allocator = {0, inline_spill, inline_free, 0};
+
+static u64 page_align(u64 size)
 {
-    u64 header_size = DARRAY_FIELD_LENGTH * sizeof(u64);
-    u64 array_size = length * stride;
-    u64* new_array = aallocate(header_size + array_size, MEMORY_TAG_DARRAY);
+    u64 page_size = amemory_page_size();
+    return (size + page_size - 1) & ~(page_size - 1);
+}
+
+// The number of bytes a virtual array must have committed to hold capacity elements.
+static u64 virtual_committed_size(u64 stride, u64 capacity)
+{
+    return page_align(DARRAY_HEADER_SIZE + capacity * stride);
+}
+
+// The capacity of a virtual array holding at least length elements, using the whole last page.
+static u64 virtual_capacity(u64 stride, u64 max_length, u64 length)
+{
+    if (length > max_length)
+    {
+        length = max_length;
+    }
+
+    u64 capacity = (virtual_committed_size(stride, length) - DARRAY_HEADER_SIZE) / stride;
+    return capacity < max_length ? capacity : max_length;
+}
+
+void *_darray_create(u64 length, u64 stride, const char* file, u32 line)
+{
+    return _darray_create_with(length, stride, 0, MEMORY_TAG_DARRAY, file, line);
+}
+
+void *_darray_create_with(u64 length, u64 stride, allocator* alloc, memory_tag tag, const char* file, u32 line)
+{
+    if (alloc == allocator_general())
+    {
+        // Same heap as no allocator, but the array is reported at the caller, not the wrapper.
+        alloc = 0;
+    }
+
+    u64 total_size = DARRAY_HEADER_SIZE + length * stride;
+    u64* new_array;
+    if (alloc)
+    {
+        new_array = alloc->allocate(alloc->state, total_size, tag);
+        if (!new_array)
+        {
+            AERROR("_darray_create_with - The allocator failed to provide %lluB.", total_size);
+            return 0;
+        }
+        azero_memory(new_array, total_size);
+    }
+    else
+    {
+        // The general heap is used directly, it hands out zeroed memory for free.
+        new_array = _aallocate(total_size, tag, file, line);
+    }
     
     new_array[DARRAY_CAPACITY] = length;
     new_array[DARRAY_LENGTH] = 0;
     new_array[DARRAY_STRIDE] = stride;
+    new_array[DARRAY_RESERVED] = 0;
+    new_array[DARRAY_ALLOCATOR] = (u64)alloc;
+    new_array[DARRAY_TAG] = tag;
+
+    return (void*)(new_array + DARRAY_FIELD_LENGTH);
+}
+
+void *_darray_create_virtual(u64 max_length, u64 stride)
+{
+    if (max_length == 0 || stride == 0)
+    {
+        AERROR("_darray_create_virtual requires a non-zero max_length and stride.");
+        return 0;
+    }
+
+    u64* new_array = areserve_memory(DARRAY_HEADER_SIZE + max_length * stride);
+    if (!new_array)
+    {
+        return 0;
+    }
+
+    // Commit the first pages, the header and as many elements as fit in them.
+    u64 capacity = virtual_capacity(stride, max_length, DARRAY_DEFAULT_CAPACITY);
+    if (!acommit_memory(new_array, virtual_committed_size(stride, capacity), MEMORY_TAG_DARRAY))
+    {
+        arelease_memory(new_array, DARRAY_HEADER_SIZE + max_length * stride);
+        return 0;
+    }
+
+    new_array[DARRAY_CAPACITY] = capacity;
+    new_array[DARRAY_LENGTH] = 0;
+    new_array[DARRAY_STRIDE] = stride;
+    new_array[DARRAY_RESERVED] = max_length;
+    new_array[DARRAY_ALLOCATOR] = 0;
+    new_array[DARRAY_TAG] = MEMORY_TAG_DARRAY;
+
+    return (void*)(new_array + DARRAY_FIELD_LENGTH);
+}
+
+void *_darray_create_inline(void* storage, u64 storage_size, u64 stride, memory_tag tag)
+{
+    if (!storage || stride == 0 || storage_size < DARRAY_HEADER_SIZE + stride)
+    {
+        AERROR("_darray_create_inline requires storage for the header and at least one element.");
+        return 0;
+    }
+
+    u64* new_array = storage;
+    new_array[DARRAY_CAPACITY] = (storage_size - DARRAY_HEADER_SIZE) / stride;
+    new_array[DARRAY_LENGTH] = 0;
+    new_array[DARRAY_STRIDE] = stride;
+    new_array[DARRAY_RESERVED] = 0;
+    new_array[DARRAY_ALLOCATOR] = (u64)&inline_allocator;
+    new_array[DARRAY_TAG] = tag;
 
     return (void*)(new_array + DARRAY_FIELD_LENGTH);
 }
@@ -19,10 +145,28 @@ void *_darray_create(u64 length, u64 stride)
 void _darray_destroy(void *array)
 {
     u64* header = (u64*)array - DARRAY_FIELD_LENGTH;
-    u64 header_size = DARRAY_FIELD_LENGTH * sizeof(u64);
-    u64 total_size = header_size + header[DARRAY_CAPACITY] * header[DARRAY_STRIDE];
+    u64 stride = header[DARRAY_STRIDE];
+    memory_tag tag = header[DARRAY_TAG];
 
-    afree(header, total_size, MEMORY_TAG_DARRAY);
+    if (header[DARRAY_RESERVED])
+    {
+        u64 reserved = header[DARRAY_RESERVED];
+        adecommit_memory(header, virtual_committed_size(stride, header[DARRAY_CAPACITY]), tag);
+        arelease_memory(header, DARRAY_HEADER_SIZE + reserved * stride);
+        return;
+    }
+
+    u64 total_size = DARRAY_HEADER_SIZE + header[DARRAY_CAPACITY] * stride;
+
+    allocator* alloc = (allocator*)header[DARRAY_ALLOCATOR];
+    if (alloc)
+    {
+        alloc->free(alloc->state, header, total_size, tag);
+    }
+    else
+    {
+        afree(header, total_size, tag);
+    }
 }
 
 u64 _darray_field_get(void *array, u64 field)
@@ -43,17 +187,126 @@ void _darray_field_set(void *array, u64 field, u64 value)
     header[field] = value;
 }
 
+// The capacity an array grows to from capacity, to hold at least min_capacity elements.
+static u64 grown_capacity(u64 capacity, u64 stride, u64 min_capacity)
+{
+    u64 new_capacity = growth_policy == DARRAY_GROWTH_ONE_AND_A_HALF ? capacity + capacity / 2 : capacity * 2;
+    if (new_capacity < min_capacity)
+    {
+        new_capacity = min_capacity;
+    }
+
+    // Large arrays grow to whole pages, nothing is left unused in the last one.
+    u64 size = DARRAY_HEADER_SIZE + new_capacity * stride;
+    if (size >= DARRAY_PAGE_GRANULAR_SIZE)
+    {
+        new_capacity = (page_align(size) - DARRAY_HEADER_SIZE) / stride;
+    }
+
+    return new_capacity;
+}
+
+// Change the capacity of an array, reallocating it in place when possible.
+// Returns the array, which may have moved. Its capacity is unchanged on failure.
+static void* darray_set_capacity(void* array, u64 capacity)
+{
+    u64* header = (u64*)array - DARRAY_FIELD_LENGTH;
+    u64 stride = header[DARRAY_STRIDE];
+    u64 old_capacity = header[DARRAY_CAPACITY];
+
+    if (header[DARRAY_RESERVED])
+    {
+        // Virtual arrays never move, commit or decommit the pages at the end.
+        capacity = virtual_capacity(stride, header[DARRAY_RESERVED], capacity);
+        u64 committed = virtual_committed_size(stride, old_capacity);
+        u64 new_committed = virtual_committed_size(stride, capacity);
+        if (new_committed > committed)
+        {
+            if (!acommit_memory((u8*)header + committed, new_committed - committed, header[DARRAY_TAG]))
+            {
+                return array;
+            }
+        }
+        else if (new_committed < committed)
+        {
+            adecommit_memory((u8*)header + new_committed, committed - new_committed, header[DARRAY_TAG]);
+        }
+
+        header[DARRAY_CAPACITY] = capacity;
+        return array;
+    }
+
+    u64 old_size = DARRAY_HEADER_SIZE + old_capacity * stride;
+    u64 new_size = DARRAY_HEADER_SIZE + capacity * stride;
+    allocator* alloc = (allocator*)header[DARRAY_ALLOCATOR];
+    // No call site given, the grown array stays reported where it was created.
+    u64* new_header = alloc
+        ? alloc->reallocate(alloc->state, header, old_size, new_size, header[DARRAY_TAG])
+        : _areallocate(header, old_size, new_size, header[DARRAY_TAG], 0, 0);
+    if (!new_header)
+    {
+        AERROR("Failed to resize darray to %llu elements.", capacity);
+        return array;
+    }
+
+    if (alloc == &inline_allocator)
+    {
+        // The array spilled, it now belongs to the general heap.
+        new_header[DARRAY_ALLOCATOR] = 0;
+    }
+
+    new_header[DARRAY_CAPACITY] = capacity;
+    return (void*)(new_header + DARRAY_FIELD_LENGTH);
+}
+
+void darray_set_growth_policy(darray_growth_policy policy)
+{
+    growth_policy = policy;
+}
+
 void *_darray_resize(void *array)
 {
-    u64 length = darray_length(array);
-    u64 stride = darray_stride(array);
-    void* temp = _darray_create(DARRAY_RESIZE_FACTOR * darray_capacity(array), stride);
+    u64* header = (u64*)array - DARRAY_FIELD_LENGTH;
+    u64 capacity = header[DARRAY_CAPACITY];
+    if (header[DARRAY_RESERVED] && capacity >= header[DARRAY_RESERVED])
+    {
+        AERROR("Virtual darray is full, it was reserved for %llu elements.", header[DARRAY_RESERVED]);
+        return array;
+    }
 
-    acopy_memory(temp, array, length * stride);
+    return darray_set_capacity(array, grown_capacity(capacity, header[DARRAY_STRIDE], capacity + 1));
+}
 
-    darray_length_set(array, length);
+void *_darray_reserve_more(void *array, u64 count)
+{
+    u64* header = (u64*)array - DARRAY_FIELD_LENGTH;
+    u64 needed = header[DARRAY_LENGTH] + count;
+    if (needed <= header[DARRAY_CAPACITY])
+    {
+        return array;
+    }
 
-    return temp;
+    if (header[DARRAY_RESERVED] && needed > header[DARRAY_RESERVED])
+    {
+        AERROR("Virtual darray can't hold %llu elements, it was reserved for %llu.", needed, header[DARRAY_RESERVED]);
+        return array;
+    }
+
+    return darray_set_capacity(array, grown_capacity(header[DARRAY_CAPACITY], header[DARRAY_STRIDE], needed));
+}
+
+void *_darray_shrink_to_fit(void *array)
+{
+    u64* header = (u64*)array - DARRAY_FIELD_LENGTH;
+    u64 length = header[DARRAY_LENGTH];
+    u64 capacity = length ? length : DARRAY_DEFAULT_CAPACITY;
+    // Inline storage costs nothing to keep, shrinking it would only spill to the heap.
+    if (capacity >= header[DARRAY_CAPACITY] || header[DARRAY_ALLOCATOR] == (u64)&inline_allocator)
+    {
+        return array;
+    }
+
+    return darray_set_capacity(array, capacity);
 }
 
 void * _darray_push(void * array, const void * value_ptr)
@@ -64,6 +317,11 @@ void * _darray_push(void * array, const void * value_ptr)
     if(length >= darray_capacity(array))
     {
         array = _darray_resize(array);
+        if(length >= darray_capacity(array))
+        {
+            // A virtual array ran out of reserved space.
+            return array;
+        }
     }
 
     u64 addr = (u64)array;
@@ -85,63 +343,127 @@ void _darray_pop(void * array, void * dest)
     darray_length_set(array, length - 1);
 }
 
-AAPI void * _darray_pop_at(void * array, u64 index, void * dest)
+void * _darray_append_n(void * array, const void * values, u64 count)
 {
     u64 length = darray_length(array);
-    u64 stride = darray_stride(array);
-    if(index >= length)
+    array = _darray_reserve_more(array, count);
+    if(length + count > darray_capacity(array))
     {
-        AERROR("Index outside the bounds of this array! Length: %i, index: %i", length, index);
+        // A virtual array ran out of reserved space.
         return array;
     }
 
-    u64 addr = (u64)array;
-    acopy_memory(dest, (void*)(addr + (index * stride)), stride);
+    u64 stride = darray_stride(array);
+    acopy_memory((u8*)array + length * stride, values, count * stride);
+    darray_length_set(array, length + count);
 
-    // If not on the last element, snip out the entry and copy the rest inward.
-    if(index != length - 1)
+    return array;
+}
+
+void * _darray_resize_uninit(void * array, u64 length)
+{
+    u64 current_length = darray_length(array);
+    if(length > current_length)
     {
-        acopy_memory(
-            (void*)(addr + (index * stride)),
-            (void*)(addr + ((index + 1) * stride)),
-            stride * (length - index)
-        );
+        array = _darray_reserve_more(array, length - current_length);
+        if(length > darray_capacity(array))
+        {
+            return array;
+        }
     }
 
-    darray_length_set(array, length - 1);
+    darray_length_set(array, length);
     return array;
 }
 
-void * _darray_insert_at(void * array, u64 index, void * value_ptr)
+void _darray_swap_remove(void * array, u64 index, void * dest)
 {
     u64 length = darray_length(array);
     u64 stride = darray_stride(array);
     if(index >= length)
     {
-        AERROR("Index outside the bounds of this array! Length: %i, index: %i", length, index);
+        AERROR("Index outside the bounds of this array! Length: %llu, index: %llu", length, index);
+        return;
+    }
+
+    u8* element = (u8*)array + index * stride;
+    if(dest)
+    {
+        acopy_memory(dest, element, stride);
+    }
+
+    // Fill the hole with the last element.
+    if(index != length - 1)
+    {
+        acopy_memory(element, (u8*)array + (length - 1) * stride, stride);
+    }
+
+    darray_length_set(array, length - 1);
+}
+
+void * _darray_insert_range(void * array, u64 index, const void * values, u64 count)
+{
+    u64 length = darray_length(array);
+    if(index > length)
+    {
+        AERROR("Index outside the bounds of this array! Length: %llu, index: %llu", length, index);
         return array;
     }
 
-    if(length >= darray_capacity(array))
+    array = _darray_reserve_more(array, count);
+    if(length + count > darray_capacity(array))
     {
-        array = _darray_resize(array);
+        // A virtual array ran out of reserved space.
+        return array;
     }
 
-    u64 addr = (u64)array;
+    // Shift the tail outward, then copy the values in the gap.
+    u64 stride = darray_stride(array);
+    u8* addr = (u8*)array;
+    amove_memory(addr + (index + count) * stride, addr + index * stride, (length - index) * stride);
+    acopy_memory(addr + index * stride, values, count * stride);
+
+    darray_length_set(array, length + count);
+    return array;
+}
 
-    // If not on the last element, copy the read half of the array outward.
-    if(index != length - 1) 
+void _darray_remove_range(void * array, u64 index, u64 count)
+{
+    u64 length = darray_length(array);
+    if(index > length || count > length - index)
     {
-        acopy_memory(
-            (void*)(addr + (index + 1) * stride),
-            (void*)(addr + (index * stride)),
-            stride * (length - index)
-        );
+        AERROR("Range outside the bounds of this array! Length: %llu, index: %llu, count: %llu", length, index, count);
+        return;
     }
 
-    // Set the value at the index.
-    acopy_memory((void*)(addr + (index * stride)), value_ptr, stride);
+    // Shift the tail inward over the removed range.
+    u64 stride = darray_stride(array);
+    u8* addr = (u8*)array;
+    amove_memory(addr + index * stride, addr + (index + count) * stride, (length - index - count) * stride);
 
-    darray_length_set(array, length + 1);
+    darray_length_set(array, length - count);
+}
+
+void * _darray_pop_at(void * array, u64 index, void * dest)
+{
+    u64 length = darray_length(array);
+    u64 stride = darray_stride(array);
+    if(index >= length)
+    {
+        AERROR("Index outside the bounds of this array! Length: %llu, index: %llu", length, index);
+        return array;
+    }
+
+    if(dest)
+    {
+        acopy_memory(dest, (u8*)array + index * stride, stride);
+    }
+
+    _darray_remove_range(array, index, 1);
     return array;
 }
+
+void * _darray_insert_at(void * array, u64 index, void * value_ptr)
+{
+    return _darray_insert_range(array, index, value_ptr, 1);
+}
@@ -1,11 +1,19 @@
 #pragma once
 
 #include "defines.h"
+#include "core/asserts.h"
+#include "core/amemory.h"
+
+struct allocator;
 
 // Memory layout
 // u64 capacity = number of elements that can be held.
 // u64 length = number of elements currently contained.
 // u64 stride = size of each element in bytes.
+// u64 reserved = maximum capacity of a virtual array, 0 for heap arrays.
+// u64 allocator = the allocator the array came from, 0 for the general heap.
+//                 Inline arrays use a private allocator until they spill to the heap.
+// u64 tag = the memory tag the array is accounted under.
 // void* elements
 
 enum
@@ -13,16 +21,40 @@ enum
     DARRAY_CAPACITY,
     DARRAY_LENGTH,
     DARRAY_STRIDE,
+    DARRAY_RESERVED,
+    DARRAY_ALLOCATOR,
+    DARRAY_TAG,
     DARRAY_FIELD_LENGTH
 };
 
-AAPI void* _darray_create(u64 length, u64 stride);
+// The file and line are the call site the array's memory is reported under when tracking.
+AAPI void* _darray_create(u64 length, u64 stride, const char* file, u32 line);
+AAPI void* _darray_create_with(u64 length, u64 stride, struct allocator* allocator, memory_tag tag, const char* file, u32 line);
+AAPI void* _darray_create_virtual(u64 max_length, u64 stride);
+AAPI void* _darray_create_inline(void* storage, u64 storage_size, u64 stride, memory_tag tag);
 AAPI void _darray_destroy(void* array);
 
+// NOTE: Kept exported for existing callers, the macros below read the header inline.
 AAPI u64 _darray_field_get(void* array, u64 field);
 AAPI void _darray_field_set(void* array, u64 field, u64 value);
 
+// Read a field of the header in front of the array. Only checked in debug builds.
+static inline u64 darray_field_get(const void* array, u64 field)
+{
+    AASSERT_DEBUG(array && field < DARRAY_FIELD_LENGTH);
+    return ((const u64*)array - DARRAY_FIELD_LENGTH)[field];
+}
+
+// Write a field of the header in front of the array. Only checked in debug builds.
+static inline void darray_field_set(void* array, u64 field, u64 value)
+{
+    AASSERT_DEBUG(array && field < DARRAY_FIELD_LENGTH);
+    ((u64*)array - DARRAY_FIELD_LENGTH)[field] = value;
+}
+
 AAPI void* _darray_resize(void* array);
+AAPI void* _darray_reserve_more(void* array, u64 count);
+AAPI void* _darray_shrink_to_fit(void* array);
 
 AAPI void* _darray_push(void* array, const void* value_ptr);
 AAPI void _darray_pop(void* array, void* dest);
@@ -30,8 +62,31 @@ AAPI void _darray_pop(void* array, void* dest);
 AAPI void* _darray_pop_at(void* array, u64 index, void* dest);
 AAPI void* _darray_insert_at(void* array, u64 index, void* value_ptr);
 
+AAPI void* _darray_append_n(void* array, const void* values, u64 count);
+AAPI void* _darray_resize_uninit(void* array, u64 length);
+AAPI void _darray_swap_remove(void* array, u64 index, void* dest);
+AAPI void* _darray_insert_range(void* array, u64 index, const void* values, u64 count);
+AAPI void _darray_remove_range(void* array, u64 index, u64 count);
+
 #define DARRAY_DEFAULT_CAPACITY 1
-#define DARRAY_RESIZE_FACTOR 2
+
+// Arrays at least this large, in bytes, grow to a whole number of pages.
+#define DARRAY_PAGE_GRANULAR_SIZE (64 * 1024)
+
+typedef enum darray_growth_policy
+{
+    // Double the capacity when full. Fewest reallocations.
+    DARRAY_GROWTH_DOUBLE,
+    // Grow the capacity by half when full. Less memory left unused, at the cost of more reallocations.
+    DARRAY_GROWTH_ONE_AND_A_HALF
+} darray_growth_policy;
+
+/**
+ * Set how every dynamic array grows when it is full. Arrays are reallocated in place when
+ * the platform allows it, large ones are remapped rather than copied.
+ * @param policy The growth policy to use. Defaults to DARRAY_GROWTH_DOUBLE.
+*/
+AAPI void darray_set_growth_policy(darray_growth_policy policy);
 
 /**
  * Create a dynamic array of a certain type.
@@ -39,7 +94,7 @@ AAPI void* _darray_insert_at(void* array, u64 index, void* value_ptr);
  * @return A pointer to the created dynamic array.
 */
 #define darray_create(type) \
-    _darray_create(DARRAY_DEFAULT_CAPACITY, sizeof(type))
+    _darray_create(DARRAY_DEFAULT_CAPACITY, sizeof(type), __FILE__, __LINE__)
 
 /**
  * Reserve a dynamic array of the passed capacity.
@@ -50,22 +105,111 @@ AAPI void* _darray_insert_at(void* array, u64 index, void* value_ptr);
  * @return A pointer to the created dynamic array.
 */
 #define darray_reserve(type, capacity) \
-    _darray_create(capacity, sizeof(type))
+    _darray_create(capacity, sizeof(type), __FILE__, __LINE__)
+
+/**
+ * Create a dynamic array taking its memory from the given allocator, accounted under the
+ * given tag. Arrays from a linear allocator don't need to be destroyed, they are reclaimed
+ * with the allocator; growing them in place only works for the last block allocated.
+ * @param type The type of elements that will be stored.
+ * @param capacity The number of elements this array can initially store.
+ * @param allocator A pointer to the allocator to use, which must outlive the array. 0/NULL
+ * for the general heap.
+ * @param tag The tag to account the array under, such as the owning subsystem's tag.
+ * @return A pointer to the created dynamic array, or 0/NULL on failure.
+*/
+#define darray_create_with(type, capacity, allocator, tag) \
+    _darray_create_with(capacity, sizeof(type), allocator, tag, __FILE__, __LINE__)
+
+/**
+ * Create a dynamic array backed by a reservation of virtual memory big enough to hold
+ * max_length elements. Pages are committed as the array grows, so growing never copies
+ * and elements never move: pointers to them stay valid until the array is destroyed.
+ * Pushing past max_length fails.
+ * @param type The type of elements that will be stored.
+ * @param max_length The maximum number of elements this array will ever store.
+ * @return A pointer to the created dynamic array, or 0/NULL on failure.
+*/
+#define darray_create_virtual(type, max_length) \
+    _darray_create_virtual(max_length, sizeof(type))
+
+/**
+ * The number of bytes needed to store an inline dynamic array of capacity elements.
+ * @param type The type of elements that will be stored.
+ * @param capacity The number of elements stored inline.
+*/
+#define darray_inline_size(type, capacity) \
+    (DARRAY_FIELD_LENGTH * sizeof(u64) + (capacity) * sizeof(type))
+
+/**
+ * Declare the storage of an inline dynamic array, as a local variable or a struct member.
+ * @param name The name of the storage.
+ * @param type The type of elements that will be stored.
+ * @param capacity The number of elements stored inline.
+*/
+#define darray_inline_storage(name, type, capacity) \
+    AALIGN(16) u64 name[(darray_inline_size(type, capacity) + sizeof(u64) - 1) / sizeof(u64)]
+
+/**
+ * Create a dynamic array in storage declared with darray_inline_storage, so small arrays
+ * don't touch the heap. The array spills to the heap when it outgrows the storage; it must
+ * still be destroyed, which only frees the spilled block. The storage must outlive the array.
+ * NOTE: The spilled block is reported under darray.c when tracking, the array has no call
+ * site of its own until then.
+ * @param type The type of elements that will be stored.
+ * @param storage The storage, declared with darray_inline_storage.
+ * @return A pointer to the created dynamic array.
+*/
+#define darray_create_inline(type, storage) \
+    _darray_create_inline(storage, sizeof(storage), sizeof(type), MEMORY_TAG_DARRAY)
 
 /**
  * Destroy the dynamic array, reclaiming the memory.
 */
 #define darray_destroy(array) _darray_destroy(array)
 
+/**
+ * Make sure the array can hold count more elements without growing, growing it once if needed.
+ * @param array A pointer to the dynamic array. Updated if the array moves.
+ * @param count The number of elements about to be added.
+*/
+#define darray_reserve_more(array, count)               \
+    {                                                   \
+        array = _darray_reserve_more(array, count);     \
+    }
+
+/**
+ * Release the capacity unused by the array. Virtual arrays keep their last page.
+ * @param array A pointer to the dynamic array. Updated if the array moves.
+*/
+#define darray_shrink_to_fit(array)                 \
+    {                                               \
+        array = _darray_shrink_to_fit(array);       \
+    }
+
 /**
  * Add an element at the end of the array and resize it if needed.
  * @param array A pointer to the dynamic array.
  * @param value The value to push into.
 */
-#define darray_push(array, value)               \
-    {                                           \
-        __auto_type temp = value;             \
-        array = _darray_push(array, &temp);     \
+#define darray_push(array, value)                                           \
+    {                                                                       \
+        __auto_type temp = value;                                           \
+        u64* temp_header = (u64*)(array) - DARRAY_FIELD_LENGTH;             \
+        if (temp_header[DARRAY_LENGTH] < temp_header[DARRAY_CAPACITY] &&    \
+            temp_header[DARRAY_STRIDE] == sizeof(temp))                     \
+        {                                                                   \
+            /* Room left, copy in place without calling into the engine. */ \
+            __builtin_memcpy(                                               \
+                (u8*)(array) + temp_header[DARRAY_LENGTH] * sizeof(temp),   \
+                &temp,                                                      \
+                sizeof(temp));                                              \
+            temp_header[DARRAY_LENGTH]++;                                   \
+        }                                                                   \
+        else                                                                \
+        {                                                                   \
+            array = _darray_push(array, &temp);                             \
+        }                                                                   \
     }
 // NOTE: could use __auto_type for temp above, but intellisense for VSCode falgs it
 // as unknown type. typeof() seems to work just fine. Both are GNU extensions.
@@ -78,11 +222,62 @@ AAPI void* _darray_insert_at(void* array, u64 index, void* value_ptr);
 #define darray_pop(array, value_ptr) \
     _darray_pop(array, value_ptr)
 
+/**
+ * Add count elements at the end of the array, growing it at most once.
+ * @param array A pointer to the dynamic array. Updated if the array moves.
+ * @param values_ptr A pointer to the elements to add.
+ * @param count The number of elements to add.
+*/
+#define darray_append_n(array, values_ptr, count)               \
+    {                                                           \
+        array = _darray_append_n(array, values_ptr, count);     \
+    }
+
+/**
+ * Set the length of the array, growing it if needed. New elements are NOT initialized.
+ * @param array A pointer to the dynamic array. Updated if the array moves.
+ * @param length The new length of the array.
+*/
+#define darray_resize_uninit(array, length)                 \
+    {                                                       \
+        array = _darray_resize_uninit(array, length);       \
+    }
+
+/**
+ * Remove an element in O(1) by moving the last element in its place. Doesn't keep the order.
+ * @param array A pointer to the dynamic array.
+ * @param index The index of the element to remove.
+ * @param value_ptr A pointer where the removed element will be returned. Can be 0/NULL.
+*/
+#define darray_swap_remove(array, index, value_ptr) \
+    _darray_swap_remove(array, index, value_ptr)
+
+/**
+ * Insert count elements at a specific index, shifting the following elements.
+ * @param array A pointer to the dynamic array. Updated if the array moves.
+ * @param index The index of the first inserted element. Can be the length of the array.
+ * @param values_ptr A pointer to the elements to insert.
+ * @param count The number of elements to insert.
+*/
+#define darray_insert_range(array, index, values_ptr, count)                \
+    {                                                                       \
+        array = _darray_insert_range(array, index, values_ptr, count);      \
+    }
+
+/**
+ * Remove count elements starting at a specific index, shifting the following elements.
+ * @param array A pointer to the dynamic array.
+ * @param index The index of the first element to remove.
+ * @param count The number of elements to remove.
+*/
+#define darray_remove_range(array, index, count) \
+    _darray_remove_range(array, index, count)
+
 /**
  * Insert an element at a specific index into a dynamic array.
  * Resize the array if needed.
  * @param array A pointer to the dynamic array.
- * @param index The index where the element will be inserted.
+ * @param index The index where the element will be inserted. Can be the length of the array.
  * @param value The element to insert into.
 */
 #define darray_insert_at(array, index, value)               \
@@ -95,7 +290,7 @@ AAPI void* _darray_insert_at(void* array, u64 index, void* value_ptr);
  * Remove an element at a specific index from a dynamic array and return it.
  * @param array A pointer to the dynamic array.
  * @param index The index where the element will be removed.
- * @param value_ptr A pointer where the removed element will be returned.
+ * @param value_ptr A pointer where the removed element will be returned. Can be 0/NULL.
 */
 #define darray_pop_at(array, index, value_ptr) \
     _darray_pop_at(array, index, value_ptr)
@@ -105,7 +300,7 @@ AAPI void* _darray_insert_at(void* array, u64 index, void* value_ptr);
  * @param array A pointer to the dynamic array.
 */
 #define darray_clear(array) \
-    _darray_field_set(array, DARRAY_LENGTH, 0)
+    darray_field_set(array, DARRAY_LENGTH, 0)
 
 /**
  * Retrieve the capacity of a dynamic array.
@@ -113,7 +308,7 @@ AAPI void* _darray_insert_at(void* array, u64 index, void* value_ptr);
  * @return The capacity of the dynamic array pointed to.
 */
 #define darray_capacity(array) \
-    _darray_field_get(array, DARRAY_CAPACITY)
+    darray_field_get(array, DARRAY_CAPACITY)
 
 /**
  * Retrive the length of a dynamic array.
@@ -121,7 +316,7 @@ AAPI void* _darray_insert_at(void* array, u64 index, void* value_ptr);
  * @return The length of the dynamic array pointed to.
 */
 #define darray_length(array) \
-    _darray_field_get(array, DARRAY_LENGTH)
+    darray_field_get(array, DARRAY_LENGTH)
 
 /**
  * Retrieve the stride of a dynamic array.
@@ -129,7 +324,7 @@ AAPI void* _darray_insert_at(void* array, u64 index, void* value_ptr);
  * @return The stride of the dynamic array pointed to.
 */
 #define darray_stride(array) \
-    _darray_field_get(array, DARRAY_STRIDE)
+    darray_field_get(array, DARRAY_STRIDE)
 
 /**
  * Set the length of a dynamic array. Usefull when you want to create a
@@ -138,4 +333,26 @@ AAPI void* _darray_insert_at(void* array, u64 index, void* value_ptr);
  * @param value The new length of this dynamic array.
 */
 #define darray_length_set(array, value) \
-    _darray_field_set(array, DARRAY_LENGTH, value)
+    darray_field_set(array, DARRAY_LENGTH, value)
+
+/**
+ * Iterate over the elements of a dynamic array by pointer. The length is read once, so
+ * the array must not grow inside the loop.
+ * @param type The type of the elements.
+ * @param item The name of the pointer to the current element.
+ * @param array A pointer to the dynamic array.
+*/
+#define darray_for_each(type, item, array)                                             \
+    /* typeof makes the * bind to every declarator, even when type is itself a pointer. */ \
+    for (__typeof__(type)* item = (type*)(array), *item##_end = (type*)(array) + darray_length(array); \
+         item < item##_end;                                                            \
+         ++item)
+
+/**
+ * Iterate over the indices of a dynamic array. The length is read once, so elements must
+ * not be added or removed inside the loop.
+ * @param index The name of the index variable.
+ * @param array A pointer to the dynamic array.
+*/
+#define darray_for_each_index(index, array) \
+    for (u64 index = 0, index##_count = darray_length(array); index < index##_count; ++index)
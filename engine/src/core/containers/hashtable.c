@@ -0,0 +1,417 @@
+#include "hashtable.h"
+
+#include "core/asserts.h"
+#include "core/logger.h"
+#include "core/amemory.h"
+#include "core/astring.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HASHTABLE_SSE2 1
+#include <emmintrin.h>
+#else
+#define HASHTABLE_SSE2 0
+#endif
+
+// Tables grow past 7/8 full. Linear probing stays short at that load since a probe step
+// checks a whole group of slots.
+#define HASHTABLE_MAX_LOAD_NUMERATOR 7
+#define HASHTABLE_MAX_LOAD_DENOMINATOR 8
+
+// The bits of a hash picking the first slot, and the 7 bits kept in the control byte.
+#define HASH_SLOT(hash) ((hash) >> 7)
+#define HASH_CONTROL(hash) ((u8)((hash) & 0x7F))
+
+// Returned by find_slot when the key isn't in the table.
+#define SLOT_NOT_FOUND 0xFFFFFFFFFFFFFFFFULL
+
+static u64 hash_u64(u64 key)
+{
+    // The 64-bit finalizer of MurmurHash3, every input bit affects every output bit.
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+    key *= 0xC4CEB9FE1A85EC53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+static u64 hash_str(const char* key)
+{
+    // FNV-1a, mixed so the high and low bits are both usable.
+    u64 hash = 0xCBF29CE484222325ULL;
+    for (const u8* c = (const u8*)key; *c; ++c)
+    {
+        hash ^= *c;
+        hash *= 0x100000001B3ULL;
+    }
+    return hash_u64(hash);
+}
+
+static u64 hash_slot_key(const hashtable* table, u64 slot)
+{
+    return table->string_keys ? hash_str(hashtable_slot_key_str(table, slot)) : hash_u64(hashtable_slot_key(table, slot));
+}
+
+// Compare the control bytes of the group starting at the given slot. Bit i of out_match is set
+// when slot + i holds the given control byte, and bit i of out_empty when it is empty.
+static inline void group_masks(const u8* group, u8 control, u32* out_match, u32* out_empty)
+{
+#if HASHTABLE_SSE2
+    __m128i bytes = _mm_loadu_si128((const __m128i*)group);
+    *out_match = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)control)));
+    // Only empty slots have the high bit set.
+    *out_empty = (u32)_mm_movemask_epi8(bytes);
+#else
+    u32 match = 0;
+    u32 empty = 0;
+    for (u32 i = 0; i < HASHTABLE_GROUP_WIDTH; ++i)
+    {
+        match |= (u32)(group[i] == control) << i;
+        empty |= (u32)(group[i] >> 7) << i;
+    }
+    *out_match = match;
+    *out_empty = empty;
+#endif
+}
+
+static inline void set_control(hashtable* table, u64 slot, u8 control)
+{
+    table->control[slot] = control;
+    if (slot < HASHTABLE_GROUP_WIDTH)
+    {
+        table->control[table->capacity + slot] = control;
+    }
+}
+
+// Probe for a key, one group at a time. Entries are never separated from their first slot by
+// an empty slot, so the probe stops at the first empty one, returned through out_empty_slot.
+static inline u64 find_slot(const hashtable* table, u64 hash, u64 key, const char* key_str, u64* out_empty_slot)
+{
+    u64 mask = table->capacity - 1;
+    u8 control = HASH_CONTROL(hash);
+    u64 position = HASH_SLOT(hash) & mask;
+
+    for (;;)
+    {
+        u32 match;
+        u32 empty;
+        group_masks(table->control + position, control, &match, &empty);
+        if (empty)
+        {
+            // Slots past the first empty one belong to other runs.
+            match &= (empty & (0u - empty)) - 1;
+        }
+
+        while (match)
+        {
+            u64 slot = (position + __builtin_ctz(match)) & mask;
+            if (key_str ? strings_equal(hashtable_slot_key_str(table, slot), key_str) : hashtable_slot_key(table, slot) == key)
+            {
+                return slot;
+            }
+            match &= match - 1;
+        }
+
+        if (empty)
+        {
+            if (out_empty_slot)
+            {
+                *out_empty_slot = (position + __builtin_ctz(empty)) & mask;
+            }
+            return SLOT_NOT_FOUND;
+        }
+
+        position = (position + HASHTABLE_GROUP_WIDTH) & mask;
+    }
+}
+
+// The first empty slot for a key that isn't in the table.
+static u64 find_empty_slot(const hashtable* table, u64 hash)
+{
+    u64 mask = table->capacity - 1;
+    u64 position = HASH_SLOT(hash) & mask;
+
+    for (;;)
+    {
+        u32 match;
+        u32 empty;
+        group_masks(table->control + position, HASHTABLE_EMPTY, &match, &empty);
+        if (empty)
+        {
+            return (position + __builtin_ctz(empty)) & mask;
+        }
+        position = (position + HASHTABLE_GROUP_WIDTH) & mask;
+    }
+}
+
+static u64 capacity_for(u64 count)
+{
+    u64 capacity = HASHTABLE_GROUP_WIDTH;
+    while (capacity * HASHTABLE_MAX_LOAD_NUMERATOR / HASHTABLE_MAX_LOAD_DENOMINATOR < count)
+    {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+// Move the entries to a table of the given capacity.
+static b8 rehash(hashtable* table, u64 capacity)
+{
+    u64 entries_size = capacity * table->entry_size;
+    u64 memory_size = entries_size + capacity + HASHTABLE_GROUP_WIDTH;
+    u8* memory = _aallocate_uninit(memory_size, MEMORY_TAG_DICT, table->file, table->line);
+    if (!memory)
+    {
+        AERROR("hashtable - Failed to allocate %llu slots (%lluB).", capacity, memory_size);
+        return FALSE;
+    }
+
+    hashtable old = *table;
+    table->capacity = capacity;
+    table->entries = memory;
+    table->control = memory + entries_size;
+    table->memory = memory;
+    table->memory_size = memory_size;
+    aset_memory(table->control, HASHTABLE_EMPTY, capacity + HASHTABLE_GROUP_WIDTH);
+
+    if (old.memory)
+    {
+        hashtable_for_each(&old, slot)
+        {
+            u64 hash = hash_slot_key(&old, slot);
+            u64 new_slot = find_empty_slot(table, hash);
+            set_control(table, new_slot, HASH_CONTROL(hash));
+            acopy_memory(table->entries + new_slot * table->entry_size, old.entries + slot * old.entry_size, table->entry_size);
+        }
+        afree(old.memory, old.memory_size, MEMORY_TAG_DICT);
+    }
+
+    return TRUE;
+}
+
+b8 _hashtable_create(u64 stride, u64 count, b8 string_keys, hashtable* out_table, const char* file, u32 line)
+{
+    if (!out_table)
+    {
+        AERROR("hashtable_create requires a valid pointer to a table.");
+        return FALSE;
+    }
+
+    azero_memory(out_table, sizeof(hashtable));
+    out_table->stride = stride;
+    out_table->entry_size = sizeof(u64) + ((stride + sizeof(u64) - 1) & ~(u64)(sizeof(u64) - 1));
+    out_table->string_keys = string_keys;
+    out_table->file = file;
+    out_table->line = line;
+
+    return rehash(out_table, capacity_for(count));
+}
+
+static void free_string_keys(hashtable* table)
+{
+    if (!table->string_keys)
+    {
+        return;
+    }
+
+    hashtable_for_each(table, slot)
+    {
+        char* key = (char*)hashtable_slot_key(table, slot);
+        afree(key, string_length(key) + 1, MEMORY_TAG_STRING);
+    }
+}
+
+void hashtable_destroy(hashtable* table)
+{
+    if (table->memory)
+    {
+        free_string_keys(table);
+        afree(table->memory, table->memory_size, MEMORY_TAG_DICT);
+    }
+
+    azero_memory(table, sizeof(hashtable));
+}
+
+b8 hashtable_reserve(hashtable* table, u64 count)
+{
+    u64 capacity = capacity_for(count);
+    if (capacity <= table->capacity)
+    {
+        return TRUE;
+    }
+
+    return rehash(table, capacity);
+}
+
+void hashtable_clear(hashtable* table)
+{
+    free_string_keys(table);
+    aset_memory(table->control, HASHTABLE_EMPTY, table->capacity + HASHTABLE_GROUP_WIDTH);
+    table->count = 0;
+}
+
+// Copy a string key, reported under the table's call site.
+static char* duplicate_key(const hashtable* table, const char* key)
+{
+    u64 size = string_length(key) + 1;
+    char* copy = _aallocate_uninit(size, MEMORY_TAG_STRING, table->file, table->line);
+    if (copy)
+    {
+        acopy_memory(copy, key, size);
+    }
+    return copy;
+}
+
+// Insert or overwrite an entry. A new string key is copied.
+static b8 set_entry(hashtable* table, u64 hash, u64 key, const char* key_str, const void* value)
+{
+    u64 empty_slot;
+    u64 slot = find_slot(table, hash, key, key_str, &empty_slot);
+    if (slot == SLOT_NOT_FOUND)
+    {
+        if ((table->count + 1) * HASHTABLE_MAX_LOAD_DENOMINATOR > table->capacity * HASHTABLE_MAX_LOAD_NUMERATOR)
+        {
+            if (!rehash(table, table->capacity * 2))
+            {
+                return FALSE;
+            }
+            empty_slot = find_empty_slot(table, hash);
+        }
+
+        // Copy the key before taking the slot, so it stays empty if the copy fails.
+        if (key_str)
+        {
+            key = (u64)duplicate_key(table, key_str);
+            if (!key)
+            {
+                return FALSE;
+            }
+        }
+
+        slot = empty_slot;
+        set_control(table, slot, HASH_CONTROL(hash));
+        hashtable_slot_key(table, slot) = key;
+        table->count++;
+    }
+
+    if (value)
+    {
+        acopy_memory(hashtable_slot_value(table, slot), value, table->stride);
+    }
+    else
+    {
+        azero_memory(hashtable_slot_value(table, slot), table->stride);
+    }
+
+    return TRUE;
+}
+
+// Remove the entry in a slot, then shift the following entries of the run back so no
+// empty slot separates an entry from its first slot.
+static void remove_slot(hashtable* table, u64 slot, void* out_value)
+{
+    if (out_value)
+    {
+        acopy_memory(out_value, hashtable_slot_value(table, slot), table->stride);
+    }
+    if (table->string_keys)
+    {
+        char* key = (char*)hashtable_slot_key(table, slot);
+        afree(key, string_length(key) + 1, MEMORY_TAG_STRING);
+    }
+
+    u64 mask = table->capacity - 1;
+    u64 hole = slot;
+    for (u64 next = (hole + 1) & mask; table->control[next] != HASHTABLE_EMPTY; next = (next + 1) & mask)
+    {
+        // An entry can fill the hole if the hole lies between its first slot and its slot.
+        u64 first = HASH_SLOT(hash_slot_key(table, next)) & mask;
+        if (((next - first) & mask) >= ((next - hole) & mask))
+        {
+            set_control(table, hole, table->control[next]);
+            acopy_memory(table->entries + hole * table->entry_size, table->entries + next * table->entry_size, table->entry_size);
+            hole = next;
+        }
+    }
+
+    set_control(table, hole, HASHTABLE_EMPTY);
+    table->count--;
+}
+
+b8 hashtable_set(hashtable* table, u64 key, const void* value)
+{
+    AASSERT_DEBUG(!table->string_keys);
+    return set_entry(table, hash_u64(key), key, 0, value);
+}
+
+void* hashtable_find(const hashtable* table, u64 key)
+{
+    AASSERT_DEBUG(!table->string_keys);
+    u64 slot = find_slot(table, hash_u64(key), key, 0, 0);
+    return slot == SLOT_NOT_FOUND ? 0 : hashtable_slot_value(table, slot);
+}
+
+b8 hashtable_remove(hashtable* table, u64 key, void* out_value)
+{
+    AASSERT_DEBUG(!table->string_keys);
+    u64 slot = find_slot(table, hash_u64(key), key, 0, 0);
+    if (slot == SLOT_NOT_FOUND)
+    {
+        return FALSE;
+    }
+
+    remove_slot(table, slot, out_value);
+    return TRUE;
+}
+
+b8 hashtable_set_str(hashtable* table, const char* key, const void* value)
+{
+    AASSERT_DEBUG(table->string_keys && key);
+    return set_entry(table, hash_str(key), 0, key, value);
+}
+
+void* hashtable_find_str(const hashtable* table, const char* key)
+{
+    AASSERT_DEBUG(table->string_keys && key);
+    u64 slot = find_slot(table, hash_str(key), 0, key, 0);
+    return slot == SLOT_NOT_FOUND ? 0 : hashtable_slot_value(table, slot);
+}
+
+b8 hashtable_remove_str(hashtable* table, const char* key, void* out_value)
+{
+    AASSERT_DEBUG(table->string_keys && key);
+    u64 slot = find_slot(table, hash_str(key), 0, key, 0);
+    if (slot == SLOT_NOT_FOUND)
+    {
+        return FALSE;
+    }
+
+    remove_slot(table, slot, out_value);
+    return TRUE;
+}
+
+u64 hashtable_next(const hashtable* table, u64 slot)
+{
+    while (slot < table->capacity)
+    {
+        u32 match;
+        u32 empty;
+        group_masks(table->control + slot, HASHTABLE_EMPTY, &match, &empty);
+        u32 full = ~empty & 0xFFFF;
+
+        // The mirrored group past the end holds slots already visited.
+        u64 remaining = table->capacity - slot;
+        if (remaining < HASHTABLE_GROUP_WIDTH)
+        {
+            full &= (1u << remaining) - 1;
+        }
+
+        if (full)
+        {
+            return slot + __builtin_ctz(full);
+        }
+        slot += HASHTABLE_GROUP_WIDTH;
+    }
+
+    return table->capacity;
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "defines.h"
+
+// An open-addressing hash map, keyed by u64 or by string, with values of any size.
+//
+// Each slot has a control byte: HASHTABLE_EMPTY, or 7 bits of the hash of its key. Lookups
+// compare the control bytes of HASHTABLE_GROUP_WIDTH slots at once, with SSE2 when available,
+// and only compare keys whose 7 bits match. Slots are probed linearly, and removals shift the
+// following entries back instead of leaving tombstones, so lookups never slow down as
+// entries come and go.
+//
+// String keys are copied into the table. Pointers to values are invalidated by any insertion
+// that grows the table and by any removal.
+
+#define HASHTABLE_GROUP_WIDTH 16
+
+// The control byte of an empty slot. Full slots hold 7 bits of the hash, with the high bit clear.
+#define HASHTABLE_EMPTY 0x80
+
+typedef struct hashtable
+{
+    // The number of slots, a power of two.
+    u64 capacity;
+    // The number of entries.
+    u64 count;
+    // The size of each value, in bytes. May be 0 to use the table as a set.
+    u64 stride;
+    b8 string_keys;
+
+    // The size of an entry: the key, or the copied string for string keys, then the value,
+    // padded to 8 bytes. Keys and values are interleaved so a hit touches one cache line.
+    u64 entry_size;
+
+    // capacity + HASHTABLE_GROUP_WIDTH control bytes. The last group mirrors the first, so a
+    // group can be loaded from any slot without wrapping.
+    u8* control;
+    u8* entries;
+
+    // The single block holding the entries and the control bytes.
+    void* memory;
+    u64 memory_size;
+
+    // The call site that created the table, to report its memory under.
+    const char* file;
+    u32 line;
+} hashtable;
+
+/**
+ * Create a hash table.
+ * @param stride The size of each value, in bytes. May be 0 to use the table as a set.
+ * @param count The number of entries the table can hold before growing. May be 0.
+ * @param string_keys TRUE to key the table by strings; FALSE for u64 keys.
+ * @param out_table A pointer to the table to initialize.
+ * @return TRUE on success; otherwise FALSE.
+ */
+#define hashtable_create(stride, count, string_keys, out_table) \
+    _hashtable_create(stride, count, string_keys, out_table, __FILE__, __LINE__)
+
+AAPI b8 _hashtable_create(u64 stride, u64 count, b8 string_keys, hashtable* out_table, const char* file, u32 line);
+
+/**
+ * Destroy a hash table, freeing its memory and its copies of the string keys.
+ * @param table A pointer to the table.
+ */
+AAPI void hashtable_destroy(hashtable* table);
+
+/**
+ * Make sure the table can hold count entries without growing.
+ * @param table A pointer to the table.
+ * @param count The number of entries.
+ * @return TRUE on success; otherwise FALSE.
+ */
+AAPI b8 hashtable_reserve(hashtable* table, u64 count);
+
+/**
+ * Remove every entry, keeping the memory.
+ * @param table A pointer to the table.
+ */
+AAPI void hashtable_clear(hashtable* table);
+
+/**
+ * Insert or overwrite the value of a key.
+ * @param table A pointer to a table keyed by u64.
+ * @param key The key.
+ * @param value A pointer to the value to copy, or 0/NULL to zero it.
+ * @return TRUE on success; otherwise FALSE.
+ */
+AAPI b8 hashtable_set(hashtable* table, u64 key, const void* value);
+
+/**
+ * Find the value of a key.
+ * @param table A pointer to a table keyed by u64.
+ * @param key The key.
+ * @return A pointer to the value in the table, or 0/NULL if the key isn't there.
+ */
+AAPI void* hashtable_find(const hashtable* table, u64 key);
+
+/**
+ * Remove a key.
+ * @param table A pointer to a table keyed by u64.
+ * @param key The key.
+ * @param out_value A pointer to copy the value to before removing it. May be 0/NULL.
+ * @return TRUE if the key was removed; FALSE if it wasn't there.
+ */
+AAPI b8 hashtable_remove(hashtable* table, u64 key, void* out_value);
+
+/**
+ * Insert or overwrite the value of a string key. The string is copied on insertion.
+ * @param table A pointer to a table keyed by strings.
+ * @param key The key.
+ * @param value A pointer to the value to copy, or 0/NULL to zero it.
+ * @return TRUE on success; otherwise FALSE.
+ */
+AAPI b8 hashtable_set_str(hashtable* table, const char* key, const void* value);
+
+/**
+ * Find the value of a string key.
+ * @param table A pointer to a table keyed by strings.
+ * @param key The key.
+ * @return A pointer to the value in the table, or 0/NULL if the key isn't there.
+ */
+AAPI void* hashtable_find_str(const hashtable* table, const char* key);
+
+/**
+ * Remove a string key, freeing the table's copy of it.
+ * @param table A pointer to a table keyed by strings.
+ * @param key The key.
+ * @param out_value A pointer to copy the value to before removing it. May be 0/NULL.
+ * @return TRUE if the key was removed; FALSE if it wasn't there.
+ */
+AAPI b8 hashtable_remove_str(hashtable* table, const char* key, void* out_value);
+
+/**
+ * Find the first full slot at or after the given slot, skipping whole groups of empty slots.
+ * @param table A pointer to the table.
+ * @param slot The slot to start from.
+ * @return The index of the slot, or the capacity of the table if there are no more entries.
+ */
+AAPI u64 hashtable_next(const hashtable* table, u64 slot);
+
+/**
+ * Iterate over the full slots of a table. Entries must not be inserted or removed meanwhile.
+ * @param table A pointer to the table.
+ * @param slot The name of the u64 slot index to declare.
+*/
+#define hashtable_for_each(table, slot) \
+    for (u64 slot = hashtable_next(table, 0); slot < (table)->capacity; slot = hashtable_next(table, slot + 1))
+
+// The key of a full slot.
+#define hashtable_slot_key(table, slot) \
+    (*(u64*)((table)->entries + (slot) * (table)->entry_size))
+
+// The string key of a full slot.
+#define hashtable_slot_key_str(table, slot) \
+    ((const char*)hashtable_slot_key(table, slot))
+
+// A pointer to the value of a full slot.
+#define hashtable_slot_value(table, slot) \
+    ((void*)((table)->entries + (slot) * (table)->entry_size + sizeof(u64)))
@@ -0,0 +1,394 @@
+#include "priority_queue.h"
+
+#include "core/logger.h"
+
+#define PRIORITY_QUEUE_ARITY 4
+
+// Bulk pushes adding at least PRIORITY_QUEUE_HEAPIFY_RATIO times as many entries as are already
+// queued rebuild the whole heap instead of sifting each entry up. From there, heapify is 2-3x
+// faster on priorities in decreasing order, where every push sifts to the root, and within 15%
+// either way on random ones. Below it, sifting up wins, by 5x and more once the queued entries
+// outnumber the added ones. See the priority_queue benchmark.
+#define PRIORITY_QUEUE_HEAPIFY_RATIO 4
+
+b8 _priority_queue_create(u64 capacity, memory_tag tag, priority_queue* out_queue, const char* file, u32 line)
+{
+    if (!out_queue)
+    {
+        AERROR("priority_queue_create requires a valid pointer to a queue.");
+        return FALSE;
+    }
+
+    if (capacity == 0)
+    {
+        capacity = DARRAY_DEFAULT_CAPACITY;
+    }
+
+    azero_memory(out_queue, sizeof(priority_queue));
+    out_queue->heap = _darray_create_with(capacity, sizeof(priority_queue_entry), 0, tag, file, line);
+    out_queue->slots = _darray_create_with(capacity, sizeof(priority_queue_slot), 0, tag, file, line);
+    out_queue->free_head = PRIORITY_QUEUE_FREE_LIST_END;
+
+    if (!out_queue->heap || !out_queue->slots)
+    {
+        AERROR("priority_queue_create - Failed to allocate %llu entries.", capacity);
+        priority_queue_destroy(out_queue);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void priority_queue_destroy(priority_queue* queue)
+{
+    if (queue->heap)
+    {
+        darray_destroy(queue->heap);
+    }
+    if (queue->slots)
+    {
+        darray_destroy(queue->slots);
+    }
+
+    azero_memory(queue, sizeof(priority_queue));
+}
+
+b8 priority_queue_reserve(priority_queue* queue, u64 capacity)
+{
+    // Slots are reused once free, so there are never more of them than entries at the peak.
+    if (darray_capacity(queue->heap) < capacity)
+    {
+        darray_reserve_more(queue->heap, capacity - darray_length(queue->heap));
+    }
+    if (darray_capacity(queue->slots) < capacity)
+    {
+        darray_reserve_more(queue->slots, capacity - darray_length(queue->slots));
+    }
+
+    if (darray_capacity(queue->heap) < capacity || darray_capacity(queue->slots) < capacity)
+    {
+        AERROR("priority_queue_reserve - Failed to reserve %llu entries.", capacity);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+// Place an entry at a heap index, pointing its slot there.
+static inline void place(priority_queue* queue, u64 index, priority_queue_entry entry)
+{
+    queue->heap[index] = entry;
+    queue->slots[entry.slot].heap_index = (u32)index;
+}
+
+// Move the entry at index toward the root while it has a lower priority than its parent.
+static void sift_up(priority_queue* queue, u64 index)
+{
+    priority_queue_entry entry = queue->heap[index];
+    while (index > 0)
+    {
+        u64 parent = (index - 1) / PRIORITY_QUEUE_ARITY;
+        if (queue->heap[parent].priority <= entry.priority)
+        {
+            break;
+        }
+        place(queue, index, queue->heap[parent]);
+        index = parent;
+    }
+    place(queue, index, entry);
+}
+
+// Move the entry at index toward the leaves while a child has a lower priority. Leaves the
+// slots behind unless track_slots is set, for heapify to fix them up in a single pass.
+static inline void sift_down_entries(priority_queue* queue, u64 index, b8 track_slots)
+{
+    priority_queue_entry* heap = queue->heap;
+    u64 count = darray_length(heap);
+    priority_queue_entry entry = heap[index];
+    for (;;)
+    {
+        u64 first_child = index * PRIORITY_QUEUE_ARITY + 1;
+        if (first_child >= count)
+        {
+            break;
+        }
+
+        // The four children are contiguous, find the lowest.
+        u64 last_child = first_child + PRIORITY_QUEUE_ARITY;
+        if (last_child > count)
+        {
+            last_child = count;
+        }
+        u64 lowest = first_child;
+        for (u64 child = first_child + 1; child < last_child; ++child)
+        {
+            if (heap[child].priority < heap[lowest].priority)
+            {
+                lowest = child;
+            }
+        }
+
+        if (heap[lowest].priority >= entry.priority)
+        {
+            break;
+        }
+        heap[index] = heap[lowest];
+        if (track_slots)
+        {
+            queue->slots[heap[index].slot].heap_index = (u32)index;
+        }
+        index = lowest;
+    }
+    place(queue, index, entry);
+}
+
+static void sift_down(priority_queue* queue, u64 index)
+{
+    sift_down_entries(queue, index, TRUE);
+}
+
+// Take a free slot or add one, holding the value. Returns PRIORITY_QUEUE_FREE_LIST_END when
+// the slots can't grow.
+static u32 allocate_slot(priority_queue* queue, u64 value)
+{
+    u32 index = queue->free_head;
+    if (index != PRIORITY_QUEUE_FREE_LIST_END)
+    {
+        queue->free_head = queue->slots[index].heap_index;
+    }
+    else
+    {
+        u64 slot_count = darray_length(queue->slots);
+        if (slot_count >= PRIORITY_QUEUE_FREE_LIST_END)
+        {
+            AERROR("priority_queue - The queue is full.");
+            return PRIORITY_QUEUE_FREE_LIST_END;
+        }
+
+        priority_queue_slot slot = {0, 1, 0};
+        darray_push(queue->slots, slot);
+        if (darray_length(queue->slots) != slot_count + 1)
+        {
+            return PRIORITY_QUEUE_FREE_LIST_END;
+        }
+        index = (u32)slot_count;
+    }
+
+    queue->slots[index].value = value;
+    return index;
+}
+
+// Stale every handle to a slot and put it on the free list.
+static void free_slot(priority_queue* queue, u32 index)
+{
+    priority_queue_slot* slot = &queue->slots[index];
+    slot->generation++;
+    if (slot->generation == 0)
+    {
+        // Skip the invalid generation on wrap-around.
+        slot->generation = 1;
+    }
+    slot->heap_index = queue->free_head;
+    queue->free_head = index;
+}
+
+// The slot of a handle, or 0/NULL if the handle is stale.
+static priority_queue_slot* live_slot(const priority_queue* queue, priority_queue_handle handle)
+{
+    if (handle.index >= darray_length(queue->slots))
+    {
+        return 0;
+    }
+
+    priority_queue_slot* slot = &queue->slots[handle.index];
+    return slot->generation == handle.generation ? slot : 0;
+}
+
+priority_queue_handle priority_queue_push(priority_queue* queue, f64 priority, u64 value)
+{
+    // Make room in the heap first, so nothing changes if it can't grow.
+    u64 count = darray_length(queue->heap);
+    if (count == darray_capacity(queue->heap))
+    {
+        darray_reserve_more(queue->heap, 1);
+        if (count == darray_capacity(queue->heap))
+        {
+            return PRIORITY_QUEUE_INVALID_HANDLE;
+        }
+    }
+
+    u32 slot = allocate_slot(queue, value);
+    if (slot == PRIORITY_QUEUE_FREE_LIST_END)
+    {
+        return PRIORITY_QUEUE_INVALID_HANDLE;
+    }
+
+    darray_length_set(queue->heap, count + 1);
+    queue->heap[count] = (priority_queue_entry){priority, slot};
+    sift_up(queue, count);
+
+    return (priority_queue_handle){slot, queue->slots[slot].generation};
+}
+
+b8 priority_queue_push_many(priority_queue* queue, const f64* priorities, const u64* values, u64 count, priority_queue_handle* out_handles)
+{
+    u64 queued_count = darray_length(queue->heap);
+    if (!priority_queue_reserve(queue, queued_count + count))
+    {
+        return FALSE;
+    }
+
+    for (u64 i = 0; i < count; ++i)
+    {
+        // Can't fail once reserved.
+        u32 slot = allocate_slot(queue, values[i]);
+        queue->heap[queued_count + i] = (priority_queue_entry){priorities[i], slot};
+        queue->slots[slot].heap_index = (u32)(queued_count + i);
+        if (out_handles)
+        {
+            out_handles[i] = (priority_queue_handle){slot, queue->slots[slot].generation};
+        }
+    }
+    darray_length_set(queue->heap, queued_count + count);
+
+    if (count >= queued_count * PRIORITY_QUEUE_HEAPIFY_RATIO)
+    {
+        // Floyd's heapify: sift down every parent, from the last one to the root.
+        // Entries move around many times, so their slots are pointed at them once at the end.
+        u64 total = queued_count + count;
+        if (total > 1)
+        {
+            for (u64 i = (total - 2) / PRIORITY_QUEUE_ARITY + 1; i > 0; --i)
+            {
+                sift_down_entries(queue, i - 1, FALSE);
+            }
+        }
+        for (u64 i = 0; i < total; ++i)
+        {
+            queue->slots[queue->heap[i].slot].heap_index = (u32)i;
+        }
+    }
+    else
+    {
+        for (u64 i = queued_count; i < queued_count + count; ++i)
+        {
+            sift_up(queue, i);
+        }
+    }
+
+    return TRUE;
+}
+
+b8 priority_queue_peek(const priority_queue* queue, f64* out_priority, u64* out_value)
+{
+    if (darray_length(queue->heap) == 0)
+    {
+        return FALSE;
+    }
+
+    if (out_priority)
+    {
+        *out_priority = queue->heap[0].priority;
+    }
+    if (out_value)
+    {
+        *out_value = queue->slots[queue->heap[0].slot].value;
+    }
+    return TRUE;
+}
+
+// Remove the entry at a heap index, filling the hole with the last entry.
+static void remove_at(priority_queue* queue, u64 index)
+{
+    free_slot(queue, queue->heap[index].slot);
+
+    u64 last = darray_length(queue->heap) - 1;
+    darray_length_set(queue->heap, last);
+    if (index == last)
+    {
+        return;
+    }
+
+    // The last entry may belong above or below the hole.
+    f64 removed_priority = queue->heap[index].priority;
+    place(queue, index, queue->heap[last]);
+    if (queue->heap[index].priority < removed_priority)
+    {
+        sift_up(queue, index);
+    }
+    else
+    {
+        sift_down(queue, index);
+    }
+}
+
+b8 priority_queue_pop(priority_queue* queue, f64* out_priority, u64* out_value)
+{
+    if (!priority_queue_peek(queue, out_priority, out_value))
+    {
+        return FALSE;
+    }
+
+    remove_at(queue, 0);
+    return TRUE;
+}
+
+b8 priority_queue_update(priority_queue* queue, priority_queue_handle handle, f64 priority)
+{
+    priority_queue_slot* slot = live_slot(queue, handle);
+    if (!slot)
+    {
+        return FALSE;
+    }
+
+    u64 index = slot->heap_index;
+    f64 old_priority = queue->heap[index].priority;
+    queue->heap[index].priority = priority;
+    if (priority < old_priority)
+    {
+        sift_up(queue, index);
+    }
+    else if (priority > old_priority)
+    {
+        sift_down(queue, index);
+    }
+    return TRUE;
+}
+
+b8 priority_queue_remove(priority_queue* queue, priority_queue_handle handle, u64* out_value)
+{
+    priority_queue_slot* slot = live_slot(queue, handle);
+    if (!slot)
+    {
+        return FALSE;
+    }
+
+    if (out_value)
+    {
+        *out_value = slot->value;
+    }
+    remove_at(queue, slot->heap_index);
+    return TRUE;
+}
+
+b8 priority_queue_priority(const priority_queue* queue, priority_queue_handle handle, f64* out_priority)
+{
+    priority_queue_slot* slot = live_slot(queue, handle);
+    if (!slot)
+    {
+        return FALSE;
+    }
+
+    *out_priority = queue->heap[slot->heap_index].priority;
+    return TRUE;
+}
+
+void priority_queue_clear(priority_queue* queue)
+{
+    u64 count = darray_length(queue->heap);
+    for (u64 i = 0; i < count; ++i)
+    {
+        free_slot(queue, queue->heap[i].slot);
+    }
+
+    darray_clear(queue->heap);
+}
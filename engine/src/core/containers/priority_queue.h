@@ -0,0 +1,158 @@
+#pragma once
+
+#include "defines.h"
+#include "core/amemory.h"
+#include "core/containers/darray.h"
+
+// A min-priority queue stored as a 4-ary heap in a darray, for timers, job priorities,
+// streaming requests and path searches.
+//
+// Each node has four children instead of two, halving the depth of the heap: a pop compares
+// more children per level, but the four sit next to each other in memory, and there are half
+// as many levels to miss the cache on.
+//
+// Every entry has a handle, as in slot_map, to change its priority or remove it wherever it
+// is in the heap. Once reserved, pushing up to the reserved count allocates nothing.
+
+typedef struct priority_queue_handle
+{
+    u32 index;
+    // 0 in invalid handles, never used by queued entries.
+    u32 generation;
+} priority_queue_handle;
+
+typedef struct priority_queue_entry
+{
+    f64 priority;
+    // The slot of the entry, to keep its heap index up to date as it moves.
+    u32 slot;
+} priority_queue_entry;
+
+typedef struct priority_queue_slot
+{
+    // The index of the entry in the heap, or of the next free slot for free slots.
+    u32 heap_index;
+    u32 generation;
+    u64 value;
+} priority_queue_slot;
+
+typedef struct priority_queue
+{
+    // A darray of the entries, ordered as a heap: the children of entry i are 4i + 1 to 4i + 4.
+    priority_queue_entry* heap;
+    // A darray of the slots the handles name.
+    priority_queue_slot* slots;
+    // The first free slot, PRIORITY_QUEUE_FREE_LIST_END if there is none.
+    u32 free_head;
+} priority_queue;
+
+#define PRIORITY_QUEUE_FREE_LIST_END 0xFFFFFFFFU
+
+// A handle that never names an entry.
+#define PRIORITY_QUEUE_INVALID_HANDLE ((priority_queue_handle){0, 0})
+
+/**
+ * Create a priority queue.
+ * @param capacity The number of entries the queue can hold before allocating.
+ * @param tag The tag to account the entries under, such as MEMORY_TAG_JOB.
+ * @param out_queue A pointer to the queue to initialize.
+ * @return TRUE on success; otherwise FALSE.
+ */
+#define priority_queue_create(capacity, tag, out_queue) \
+    _priority_queue_create(capacity, tag, out_queue, __FILE__, __LINE__)
+
+AAPI b8 _priority_queue_create(u64 capacity, memory_tag tag, priority_queue* out_queue, const char* file, u32 line);
+
+/**
+ * Destroy a priority queue. Every handle becomes stale.
+ * @param queue A pointer to the queue.
+ */
+AAPI void priority_queue_destroy(priority_queue* queue);
+
+/**
+ * Make sure the queue can hold a number of entries without allocating.
+ * @param queue A pointer to the queue.
+ * @param capacity The number of entries.
+ * @return TRUE on success; otherwise FALSE.
+ */
+AAPI b8 priority_queue_reserve(priority_queue* queue, u64 capacity);
+
+/**
+ * Add an entry.
+ * @param queue A pointer to the queue.
+ * @param priority The priority of the entry. The lowest is popped first.
+ * @param value The value of the entry, such as an index or a handle.
+ * @return The handle of the entry, or PRIORITY_QUEUE_INVALID_HANDLE on failure.
+ */
+AAPI priority_queue_handle priority_queue_push(priority_queue* queue, f64 priority, u64 value);
+
+/**
+ * Add many entries at once. When the queue held at most a quarter as many entries as are added,
+ * restores the heap bottom-up in linear time, which mostly pays off on priorities in decreasing
+ * order; otherwise sifts each entry up as priority_queue_push would.
+ * @param queue A pointer to the queue.
+ * @param priorities A pointer to the priorities of the entries.
+ * @param values A pointer to the values of the entries.
+ * @param count The number of entries.
+ * @param out_handles A pointer to an array of count handles to fill in. May be 0/NULL.
+ * @return TRUE on success; FALSE on allocation failure, leaving the queue unchanged.
+ */
+AAPI b8 priority_queue_push_many(priority_queue* queue, const f64* priorities, const u64* values, u64 count, priority_queue_handle* out_handles);
+
+/**
+ * Retrieve the entry with the lowest priority without removing it.
+ * @param queue A pointer to the queue.
+ * @param out_priority A pointer to copy the priority to. May be 0/NULL.
+ * @param out_value A pointer to copy the value to. May be 0/NULL.
+ * @return TRUE if the queue holds an entry; FALSE if it is empty.
+ */
+AAPI b8 priority_queue_peek(const priority_queue* queue, f64* out_priority, u64* out_value);
+
+/**
+ * Remove the entry with the lowest priority.
+ * @param queue A pointer to the queue.
+ * @param out_priority A pointer to copy the priority to. May be 0/NULL.
+ * @param out_value A pointer to copy the value to. May be 0/NULL.
+ * @return TRUE if an entry was removed; FALSE if the queue is empty.
+ */
+AAPI b8 priority_queue_pop(priority_queue* queue, f64* out_priority, u64* out_value);
+
+/**
+ * Change the priority of an entry, lowering it for a decrease-key or raising it.
+ * @param queue A pointer to the queue.
+ * @param handle The handle of the entry.
+ * @param priority The new priority.
+ * @return TRUE if the priority was changed; FALSE if the handle is stale.
+ */
+AAPI b8 priority_queue_update(priority_queue* queue, priority_queue_handle handle, f64 priority);
+
+/**
+ * Remove an entry wherever it is in the heap.
+ * @param queue A pointer to the queue.
+ * @param handle The handle of the entry.
+ * @param out_value A pointer to copy the value to before removing it. May be 0/NULL.
+ * @return TRUE if the entry was removed; FALSE if the handle is stale.
+ */
+AAPI b8 priority_queue_remove(priority_queue* queue, priority_queue_handle handle, u64* out_value);
+
+/**
+ * Retrieve the priority of an entry.
+ * @param queue A pointer to the queue.
+ * @param handle The handle of the entry.
+ * @param out_priority A pointer to copy the priority to.
+ * @return TRUE if the handle names a queued entry; otherwise FALSE.
+ */
+AAPI b8 priority_queue_priority(const priority_queue* queue, priority_queue_handle handle, f64* out_priority);
+
+/**
+ * Remove every entry. Every handle becomes stale.
+ * @param queue A pointer to the queue.
+ */
+AAPI void priority_queue_clear(priority_queue* queue);
+
+// TRUE if the handle names a queued entry.
+#define priority_queue_contains(queue, handle) \
+    priority_queue_priority(queue, handle, &(f64){0})
+
+#define priority_queue_count(queue) \
+    darray_length((queue)->heap)
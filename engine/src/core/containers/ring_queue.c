@@ -0,0 +1,209 @@
+#include "ring_queue.h"
+
+#include "core/logger.h"
+#include "core/amemory.h"
+
+static u64 power_of_two_at_least(u64 value)
+{
+    u64 result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+b8 _ring_queue_spsc_create(u64 stride, u64 capacity, ring_queue_spsc* out_queue, const char* file, u32 line)
+{
+    if (!out_queue || stride == 0 || capacity == 0)
+    {
+        AERROR("ring_queue_spsc_create requires a valid pointer to a queue, a non-zero stride and capacity.");
+        return FALSE;
+    }
+
+    azero_memory(out_queue, sizeof(ring_queue_spsc));
+    capacity = power_of_two_at_least(capacity);
+    out_queue->elements = _aallocate_aligned(capacity * stride, ACACHE_LINE_SIZE, MEMORY_TAG_RING_QUEUE, file, line);
+    if (!out_queue->elements)
+    {
+        AERROR("ring_queue_spsc_create - Failed to allocate %llu elements.", capacity);
+        return FALSE;
+    }
+
+    out_queue->mask = capacity - 1;
+    out_queue->stride = stride;
+    return TRUE;
+}
+
+void ring_queue_spsc_destroy(ring_queue_spsc* queue)
+{
+    if (queue->elements)
+    {
+        afree_aligned(queue->elements, (queue->mask + 1) * queue->stride, ACACHE_LINE_SIZE, MEMORY_TAG_RING_QUEUE);
+    }
+    azero_memory(queue, sizeof(ring_queue_spsc));
+}
+
+b8 ring_queue_spsc_push(ring_queue_spsc* queue, const void* value)
+{
+    u64 tail = queue->tail;
+    if (tail - queue->head_cache > queue->mask)
+    {
+        // Looks full, see how far the consumer got.
+        queue->head_cache = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+        if (tail - queue->head_cache > queue->mask)
+        {
+            return FALSE;
+        }
+    }
+
+    acopy_memory(queue->elements + (tail & queue->mask) * queue->stride, value, queue->stride);
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+    return TRUE;
+}
+
+b8 ring_queue_spsc_pop(ring_queue_spsc* queue, void* out_value)
+{
+    u64 head = queue->head;
+    if (head == queue->tail_cache)
+    {
+        // Looks empty, see how far the producer got.
+        queue->tail_cache = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+        if (head == queue->tail_cache)
+        {
+            return FALSE;
+        }
+    }
+
+    acopy_memory(out_value, queue->elements + (head & queue->mask) * queue->stride, queue->stride);
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+    return TRUE;
+}
+
+u64 ring_queue_spsc_count(ring_queue_spsc* queue)
+{
+    u64 head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    u64 tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    return tail - head;
+}
+
+#define CELL(queue, position) ((queue)->cells + ((position) & (queue)->mask) * (queue)->cell_size)
+
+b8 _ring_queue_mpmc_create(u64 stride, u64 capacity, ring_queue_mpmc* out_queue, const char* file, u32 line)
+{
+    if (!out_queue || stride == 0 || capacity == 0)
+    {
+        AERROR("ring_queue_mpmc_create requires a valid pointer to a queue, a non-zero stride and capacity.");
+        return FALSE;
+    }
+
+    azero_memory(out_queue, sizeof(ring_queue_mpmc));
+    // With a single cell, a cell ready to be read would look ready to be written.
+    capacity = power_of_two_at_least(capacity < 2 ? 2 : capacity);
+    out_queue->cell_size = sizeof(u64) + ((stride + sizeof(u64) - 1) & ~(u64)(sizeof(u64) - 1));
+    out_queue->cells = _aallocate_aligned(capacity * out_queue->cell_size, ACACHE_LINE_SIZE, MEMORY_TAG_RING_QUEUE, file, line);
+    if (!out_queue->cells)
+    {
+        AERROR("ring_queue_mpmc_create - Failed to allocate %llu elements.", capacity);
+        return FALSE;
+    }
+
+    out_queue->mask = capacity - 1;
+    out_queue->stride = stride;
+
+    // Cell i is first written at position i.
+    for (u64 i = 0; i < capacity; ++i)
+    {
+        *(u64*)CELL(out_queue, i) = i;
+    }
+
+    return TRUE;
+}
+
+void ring_queue_mpmc_destroy(ring_queue_mpmc* queue)
+{
+    if (queue->cells)
+    {
+        afree_aligned(queue->cells, (queue->mask + 1) * queue->cell_size, ACACHE_LINE_SIZE, MEMORY_TAG_RING_QUEUE);
+    }
+    azero_memory(queue, sizeof(ring_queue_mpmc));
+}
+
+// A cell is ready to be written at position p when its sequence is p, and ready to be read
+// when its sequence is p + 1. Reading it sets its sequence to the next position writing it,
+// p + capacity.
+
+b8 ring_queue_mpmc_push(ring_queue_mpmc* queue, const void* value)
+{
+    u64 position = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+    u8* cell;
+    for (;;)
+    {
+        cell = CELL(queue, position);
+        u64 sequence = __atomic_load_n((u64*)cell, __ATOMIC_ACQUIRE);
+        i64 difference = (i64)(sequence - position);
+        if (difference == 0)
+        {
+            // The cell is free, claim the position. On failure, position holds the new tail.
+            if (__atomic_compare_exchange_n(&queue->tail, &position, position + 1, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            // The cell still holds the element from a lap ago.
+            return FALSE;
+        }
+        else
+        {
+            // Another producer claimed the position.
+            position = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    acopy_memory(cell + sizeof(u64), value, queue->stride);
+    __atomic_store_n((u64*)cell, position + 1, __ATOMIC_RELEASE);
+    return TRUE;
+}
+
+b8 ring_queue_mpmc_pop(ring_queue_mpmc* queue, void* out_value)
+{
+    u64 position = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+    u8* cell;
+    for (;;)
+    {
+        cell = CELL(queue, position);
+        u64 sequence = __atomic_load_n((u64*)cell, __ATOMIC_ACQUIRE);
+        i64 difference = (i64)(sequence - (position + 1));
+        if (difference == 0)
+        {
+            // The cell is written, claim the position. On failure, position holds the new head.
+            if (__atomic_compare_exchange_n(&queue->head, &position, position + 1, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            // Nothing written at this position yet.
+            return FALSE;
+        }
+        else
+        {
+            // Another consumer claimed the position.
+            position = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    acopy_memory(out_value, cell + sizeof(u64), queue->stride);
+    __atomic_store_n((u64*)cell, position + queue->mask + 1, __ATOMIC_RELEASE);
+    return TRUE;
+}
+
+u64 ring_queue_mpmc_count(ring_queue_mpmc* queue)
+{
+    u64 head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    u64 tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    return tail > head ? tail - head : 0;
+}
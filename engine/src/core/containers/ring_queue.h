@@ -0,0 +1,133 @@
+#pragma once
+
+#include "defines.h"
+
+// Bounded lock-free ring queues of fixed-size elements. The capacity is rounded up to a power
+// of two. Pushing to a full queue or popping from an empty one fails immediately, callers
+// decide whether to retry, drop or block.
+//
+// The indices written by producers and by consumers sit on separate cache lines, so the two
+// sides don't invalidate each other's lines on every operation.
+
+/**
+ * A single-producer/single-consumer queue. Push and pop are wait-free, but each may only be
+ * called from one thread at a time.
+ */
+typedef struct ring_queue_spsc
+{
+    // Read-only after creation.
+    u64 mask;
+    u64 stride;
+    u8* elements;
+
+    // Written by the producer. head_cache spares a read of the consumer's line per push.
+    AALIGN(ACACHE_LINE_SIZE) u64 tail;
+    u64 head_cache;
+
+    // Written by the consumer. tail_cache spares a read of the producer's line per pop.
+    AALIGN(ACACHE_LINE_SIZE) u64 head;
+    u64 tail_cache;
+} ring_queue_spsc;
+
+/**
+ * A multi-producer/multi-consumer queue. Every cell carries a sequence number telling
+ * whether it is ready to be written or read at a given position, so producers and consumers
+ * only contend on the index they advance.
+ */
+typedef struct ring_queue_mpmc
+{
+    // Read-only after creation.
+    u64 mask;
+    u64 stride;
+    // The size of a cell: its sequence number then the element, padded to 8 bytes.
+    u64 cell_size;
+    u8* cells;
+
+    // Advanced by producers.
+    AALIGN(ACACHE_LINE_SIZE) u64 tail;
+
+    // Advanced by consumers.
+    AALIGN(ACACHE_LINE_SIZE) u64 head;
+} ring_queue_mpmc;
+
+/**
+ * Create a single-producer/single-consumer queue.
+ * @param stride The size of each element, in bytes.
+ * @param capacity The number of elements the queue can hold. Rounded up to a power of two.
+ * @param out_queue A pointer to the queue to initialize.
+ * @return TRUE on success; otherwise FALSE.
+ */
+#define ring_queue_spsc_create(stride, capacity, out_queue) \
+    _ring_queue_spsc_create(stride, capacity, out_queue, __FILE__, __LINE__)
+
+AAPI b8 _ring_queue_spsc_create(u64 stride, u64 capacity, ring_queue_spsc* out_queue, const char* file, u32 line);
+
+/**
+ * Destroy a single-producer/single-consumer queue. No thread may be using it.
+ * @param queue A pointer to the queue.
+ */
+AAPI void ring_queue_spsc_destroy(ring_queue_spsc* queue);
+
+/**
+ * Push an element. Only call from the producer thread.
+ * @param queue A pointer to the queue.
+ * @param value A pointer to the element to copy.
+ * @return TRUE on success; FALSE if the queue is full.
+ */
+AAPI b8 ring_queue_spsc_push(ring_queue_spsc* queue, const void* value);
+
+/**
+ * Pop the oldest element. Only call from the consumer thread.
+ * @param queue A pointer to the queue.
+ * @param out_value A pointer to copy the element to.
+ * @return TRUE on success; FALSE if the queue is empty.
+ */
+AAPI b8 ring_queue_spsc_pop(ring_queue_spsc* queue, void* out_value);
+
+/**
+ * Count the elements in the queue. Only a snapshot while other threads use the queue.
+ * @param queue A pointer to the queue.
+ * @return The number of elements.
+ */
+AAPI u64 ring_queue_spsc_count(ring_queue_spsc* queue);
+
+/**
+ * Create a multi-producer/multi-consumer queue.
+ * @param stride The size of each element, in bytes.
+ * @param capacity The number of elements the queue can hold. Rounded up to a power of two, 2 at least.
+ * @param out_queue A pointer to the queue to initialize.
+ * @return TRUE on success; otherwise FALSE.
+ */
+#define ring_queue_mpmc_create(stride, capacity, out_queue) \
+    _ring_queue_mpmc_create(stride, capacity, out_queue, __FILE__, __LINE__)
+
+AAPI b8 _ring_queue_mpmc_create(u64 stride, u64 capacity, ring_queue_mpmc* out_queue, const char* file, u32 line);
+
+/**
+ * Destroy a multi-producer/multi-consumer queue. No thread may be using it.
+ * @param queue A pointer to the queue.
+ */
+AAPI void ring_queue_mpmc_destroy(ring_queue_mpmc* queue);
+
+/**
+ * Push an element. Lock-free, callable from any thread.
+ * @param queue A pointer to the queue.
+ * @param value A pointer to the element to copy.
+ * @return TRUE on success; FALSE if the queue is full.
+ */
+AAPI b8 ring_queue_mpmc_push(ring_queue_mpmc* queue, const void* value);
+
+/**
+ * Pop the oldest element. Lock-free, callable from any thread.
+ * @param queue A pointer to the queue.
+ * @param out_value A pointer to copy the element to.
+ * @return TRUE on success; FALSE if the queue is empty.
+ */
+AAPI b8 ring_queue_mpmc_pop(ring_queue_mpmc* queue, void* out_value);
+
+/**
+ * Count the elements in the queue. Only a snapshot while other threads use the queue.
+ * @param queue A pointer to the queue.
+ * @return The number of elements.
+ */
+AAPI u64 ring_queue_mpmc_count(ring_queue_mpmc* queue);
@@ -0,0 +1,196 @@
+#include "slot_map.h"
+
+#include "core/logger.h"
+
+b8 _slot_map_create(u64 stride, u64 capacity, memory_tag tag, slot_map* out_map, const char* file, u32 line)
+{
+    if (!out_map || stride == 0)
+    {
+        AERROR("slot_map_create requires a valid pointer to a map and a non-zero stride.");
+        return FALSE;
+    }
+
+    if (capacity == 0)
+    {
+        capacity = DARRAY_DEFAULT_CAPACITY;
+    }
+
+    azero_memory(out_map, sizeof(slot_map));
+    out_map->objects = _darray_create_with(capacity, stride, 0, tag, file, line);
+    out_map->object_slots = _darray_create_with(capacity, sizeof(u32), 0, tag, file, line);
+    out_map->slots = _darray_create_with(capacity, sizeof(slot_map_slot), 0, tag, file, line);
+    out_map->free_head = SLOT_MAP_FREE_LIST_END;
+    out_map->tag = tag;
+
+    if (!out_map->objects || !out_map->object_slots || !out_map->slots)
+    {
+        AERROR("slot_map_create - Failed to allocate %llu objects.", capacity);
+        slot_map_destroy(out_map);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void slot_map_destroy(slot_map* map)
+{
+    if (map->objects)
+    {
+        darray_destroy(map->objects);
+    }
+    if (map->object_slots)
+    {
+        darray_destroy(map->object_slots);
+    }
+    if (map->slots)
+    {
+        darray_destroy(map->slots);
+    }
+
+    azero_memory(map, sizeof(slot_map));
+}
+
+slot_map_handle slot_map_insert(slot_map* map, const void* value)
+{
+    u64 dense_index = darray_length(map->objects);
+    if (dense_index >= SLOT_MAP_FREE_LIST_END)
+    {
+        AERROR("slot_map_insert - The map is full.");
+        return SLOT_MAP_INVALID_HANDLE;
+    }
+
+    // Make room in every array first, so nothing changes if one can't grow.
+    if (darray_capacity(map->object_slots) <= dense_index)
+    {
+        darray_reserve_more(map->object_slots, 1);
+        if (darray_capacity(map->object_slots) <= dense_index)
+        {
+            return SLOT_MAP_INVALID_HANDLE;
+        }
+    }
+    u64 slot_count = darray_length(map->slots);
+    if (map->free_head == SLOT_MAP_FREE_LIST_END && slot_count == darray_capacity(map->slots))
+    {
+        darray_reserve_more(map->slots, 1);
+        if (slot_count == darray_capacity(map->slots))
+        {
+            return SLOT_MAP_INVALID_HANDLE;
+        }
+    }
+
+    map->objects = _darray_resize_uninit(map->objects, dense_index + 1);
+    if (darray_length(map->objects) != dense_index + 1)
+    {
+        return SLOT_MAP_INVALID_HANDLE;
+    }
+
+    void* object = (u8*)map->objects + dense_index * darray_stride(map->objects);
+    if (value)
+    {
+        acopy_memory(object, value, darray_stride(map->objects));
+    }
+    else
+    {
+        azero_memory(object, darray_stride(map->objects));
+    }
+
+    u32 index = map->free_head;
+    if (index != SLOT_MAP_FREE_LIST_END)
+    {
+        map->free_head = map->slots[index].dense_index;
+    }
+    else
+    {
+        index = (u32)slot_count;
+        slot_map_slot slot = {0, 1};
+        darray_push(map->slots, slot);
+    }
+
+    map->slots[index].dense_index = (u32)dense_index;
+    darray_push(map->object_slots, index);
+
+    return (slot_map_handle){index, map->slots[index].generation};
+}
+
+// Stale every handle to a slot and put it on the free list.
+static void free_slot(slot_map* map, u32 index)
+{
+    slot_map_slot* slot = &map->slots[index];
+    slot->generation++;
+    if (slot->generation == 0)
+    {
+        // Skip the invalid generation on wrap-around.
+        slot->generation = 1;
+    }
+    slot->dense_index = map->free_head;
+    map->free_head = index;
+}
+
+// The slot of a handle, or 0/NULL if the handle is stale.
+static slot_map_slot* live_slot(const slot_map* map, slot_map_handle handle)
+{
+    if (handle.index >= darray_length(map->slots))
+    {
+        return 0;
+    }
+
+    slot_map_slot* slot = &map->slots[handle.index];
+    return slot->generation == handle.generation ? slot : 0;
+}
+
+b8 slot_map_remove(slot_map* map, slot_map_handle handle, void* out_value)
+{
+    slot_map_slot* slot = live_slot(map, handle);
+    if (!slot)
+    {
+        return FALSE;
+    }
+
+    // Fill the hole with the last object, and point its slot at its new place.
+    u32 dense_index = slot->dense_index;
+    u32 last_index = (u32)darray_length(map->objects) - 1;
+    if (dense_index != last_index)
+    {
+        map->slots[map->object_slots[last_index]].dense_index = dense_index;
+    }
+    darray_swap_remove(map->objects, dense_index, out_value);
+    darray_swap_remove(map->object_slots, dense_index, 0);
+
+    free_slot(map, handle.index);
+    return TRUE;
+}
+
+void* slot_map_get(const slot_map* map, slot_map_handle handle)
+{
+    slot_map_slot* slot = live_slot(map, handle);
+    if (!slot)
+    {
+        return 0;
+    }
+
+    return (u8*)map->objects + (u64)slot->dense_index * darray_stride(map->objects);
+}
+
+slot_map_handle slot_map_handle_at(const slot_map* map, u64 dense_index)
+{
+    if (dense_index >= darray_length(map->objects))
+    {
+        return SLOT_MAP_INVALID_HANDLE;
+    }
+
+    u32 index = map->object_slots[dense_index];
+    return (slot_map_handle){index, map->slots[index].generation};
+}
+
+void slot_map_clear(slot_map* map)
+{
+    // Free every live slot, in dense order.
+    u64 count = darray_length(map->objects);
+    for (u64 i = 0; i < count; ++i)
+    {
+        free_slot(map, map->object_slots[i]);
+    }
+
+    darray_clear(map->objects);
+    darray_clear(map->object_slots);
+}
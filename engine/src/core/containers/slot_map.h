@@ -0,0 +1,114 @@
+#pragma once
+
+#include "defines.h"
+#include "core/amemory.h"
+#include "core/containers/darray.h"
+
+// A slot map stores objects densely in a darray and hands out handles that stay valid while
+// objects around them are added, removed and moved.
+//
+// A handle names a slot, and the slot points to the object in the dense array. Removing an
+// object moves the last object in its place and updates that object's slot, so the dense
+// array never has holes. Each slot counts its generation, bumped on every removal; a handle
+// whose generation doesn't match its slot is stale and resolves to nothing.
+
+typedef struct slot_map_handle
+{
+    u32 index;
+    // 0 in invalid handles, never used by live objects.
+    u32 generation;
+} slot_map_handle;
+
+typedef struct slot_map_slot
+{
+    // The index of the object in the dense array, or of the next free slot for free slots.
+    u32 dense_index;
+    u32 generation;
+} slot_map_slot;
+
+typedef struct slot_map
+{
+    // A darray of the objects, packed.
+    void* objects;
+    // A darray of the slot of each object, to fix the slot up when the object moves.
+    u32* object_slots;
+    // A darray of the slots.
+    slot_map_slot* slots;
+    // The first free slot, SLOT_MAP_FREE_LIST_END if there is none.
+    u32 free_head;
+    memory_tag tag;
+} slot_map;
+
+#define SLOT_MAP_FREE_LIST_END 0xFFFFFFFFU
+
+// A handle that never resolves to an object.
+#define SLOT_MAP_INVALID_HANDLE ((slot_map_handle){0, 0})
+
+/**
+ * Create a slot map.
+ * @param stride The size of each object, in bytes.
+ * @param capacity The number of objects the map can initially store.
+ * @param tag The tag to account the objects under, such as MEMORY_TAG_ENTITY.
+ * @param out_map A pointer to the map to initialize.
+ * @return TRUE on success; otherwise FALSE.
+ */
+#define slot_map_create(stride, capacity, tag, out_map) \
+    _slot_map_create(stride, capacity, tag, out_map, __FILE__, __LINE__)
+
+AAPI b8 _slot_map_create(u64 stride, u64 capacity, memory_tag tag, slot_map* out_map, const char* file, u32 line);
+
+/**
+ * Destroy a slot map. Every handle becomes stale.
+ * @param map A pointer to the map.
+ */
+AAPI void slot_map_destroy(slot_map* map);
+
+/**
+ * Insert an object.
+ * @param map A pointer to the map.
+ * @param value A pointer to the object to copy, or 0/NULL to zero it.
+ * @return The handle of the object, or SLOT_MAP_INVALID_HANDLE on failure.
+ */
+AAPI slot_map_handle slot_map_insert(slot_map* map, const void* value);
+
+/**
+ * Remove an object. Moves the last object in the dense array, invalidating pointers to it.
+ * @param map A pointer to the map.
+ * @param handle The handle of the object.
+ * @param out_value A pointer to copy the object to before removing it. May be 0/NULL.
+ * @return TRUE if the object was removed; FALSE if the handle is stale.
+ */
+AAPI b8 slot_map_remove(slot_map* map, slot_map_handle handle, void* out_value);
+
+/**
+ * Find an object. The pointer is valid until the next insertion or removal.
+ * @param map A pointer to the map.
+ * @param handle The handle of the object.
+ * @return A pointer to the object, or 0/NULL if the handle is stale.
+ */
+AAPI void* slot_map_get(const slot_map* map, slot_map_handle handle);
+
+/**
+ * Retrieve the handle of an object from its position in the dense array.
+ * @param map A pointer to the map.
+ * @param dense_index The index of the object in slot_map_objects.
+ * @return The handle of the object.
+ */
+AAPI slot_map_handle slot_map_handle_at(const slot_map* map, u64 dense_index);
+
+/**
+ * Remove every object. Every handle becomes stale.
+ * @param map A pointer to the map.
+ */
+AAPI void slot_map_clear(slot_map* map);
+
+// TRUE if the handle resolves to an object.
+#define slot_map_contains(map, handle) \
+    (slot_map_get(map, handle) != 0)
+
+// The objects, packed in a darray. Iterate with darray_for_each to touch only live objects.
+#define slot_map_objects(map) \
+    ((map)->objects)
+
+#define slot_map_count(map) \
+    darray_length((map)->objects)
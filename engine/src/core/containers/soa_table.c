@@ -0,0 +1,124 @@
+#include "soa_table.h"
+
+#include "core/logger.h"
+
+static u64 column_size(u64 stride, u64 capacity)
+{
+    return (stride * capacity + SOA_TABLE_ALIGNMENT - 1) & ~(u64)(SOA_TABLE_ALIGNMENT - 1);
+}
+
+// Allocate a block for capacity elements and point the columns into it, copying the
+// existing elements over. The old block is freed. Returns FALSE on failure, leaving the
+// table untouched.
+static b8 soa_table_set_capacity(soa_table* table, void** columns, u64 capacity)
+{
+    u64 memory_size = 0;
+    for (u32 i = 0; i < table->column_count; ++i)
+    {
+        memory_size += column_size(table->strides[i], capacity);
+    }
+
+    // Elements are pushed uninitialized and the old ones are copied over, nothing to clear.
+    u8* memory = _aallocate_aligned_uninit(memory_size, SOA_TABLE_ALIGNMENT, table->tag, table->file, table->line);
+    if (!memory)
+    {
+        AERROR("soa_table - Failed to allocate %llu elements (%lluB).", capacity, memory_size);
+        return FALSE;
+    }
+
+    u64 offset = 0;
+    for (u32 i = 0; i < table->column_count; ++i)
+    {
+        void* column = memory + offset;
+        if (table->length)
+        {
+            acopy_memory(column, columns[i], table->length * table->strides[i]);
+        }
+        columns[i] = column;
+        offset += column_size(table->strides[i], capacity);
+    }
+
+    if (table->memory)
+    {
+        afree_aligned(table->memory, table->memory_size, SOA_TABLE_ALIGNMENT, table->tag);
+    }
+
+    table->memory = memory;
+    table->memory_size = memory_size;
+    table->capacity = capacity;
+    return TRUE;
+}
+
+b8 _soa_table_create(soa_table* table, void** columns, const u64* strides, u32 column_count, u64 capacity, memory_tag tag, const char* file, u32 line)
+{
+    if (column_count == 0 || column_count > SOA_TABLE_MAX_COLUMNS)
+    {
+        AERROR("soa_table_create - A table needs 1 to %u columns, got %u.", SOA_TABLE_MAX_COLUMNS, column_count);
+        return FALSE;
+    }
+
+    azero_memory(table, sizeof(soa_table));
+    table->column_count = column_count;
+    table->tag = tag;
+    table->file = file;
+    table->line = line;
+    acopy_memory(table->strides, strides, column_count * sizeof(u64));
+
+    return soa_table_set_capacity(table, columns, capacity ? capacity : 1);
+}
+
+void _soa_table_destroy(soa_table* table, void** columns)
+{
+    if (table->memory)
+    {
+        afree_aligned(table->memory, table->memory_size, SOA_TABLE_ALIGNMENT, table->tag);
+    }
+
+    for (u32 i = 0; i < table->column_count; ++i)
+    {
+        columns[i] = 0;
+    }
+    azero_memory(table, sizeof(soa_table));
+}
+
+b8 _soa_table_reserve(soa_table* table, void** columns, u64 capacity)
+{
+    if (capacity <= table->capacity)
+    {
+        return TRUE;
+    }
+
+    return soa_table_set_capacity(table, columns, capacity);
+}
+
+u64 _soa_table_push(soa_table* table, void** columns)
+{
+    if (table->length >= table->capacity && !soa_table_set_capacity(table, columns, table->capacity * 2))
+    {
+        return SOA_TABLE_INVALID_INDEX;
+    }
+
+    return table->length++;
+}
+
+void _soa_table_swap_remove(soa_table* table, void** columns, u64 index)
+{
+    if (index >= table->length)
+    {
+        AERROR("Index outside the bounds of this table! Length: %llu, index: %llu", table->length, index);
+        return;
+    }
+
+    u64 last = table->length - 1;
+    if (index != last)
+    {
+        for (u32 i = 0; i < table->column_count; ++i)
+        {
+            u64 stride = table->strides[i];
+            u8* column = columns[i];
+            acopy_memory(column + index * stride, column + last * stride, stride);
+        }
+    }
+
+    table->length = last;
+}
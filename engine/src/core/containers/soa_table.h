@@ -0,0 +1,122 @@
+#pragma once
+
+#include "defines.h"
+#include "core/amemory.h"
+
+// A struct-of-arrays table: one contiguous column per field, sharing a length and a capacity.
+// Loops reading a few fields only pull those fields through the cache.
+//
+// The fields are listed with an X-macro, then the table type is defined from it:
+//
+//     #define PARTICLE_FIELDS(X) X(vec3, position) X(vec3, velocity) X(f32, life)
+//
+//     soa_table_define(particle_table, PARTICLE_FIELDS);
+//
+//     particle_table particles;
+//     soa_table_create(&particles, PARTICLE_FIELDS, 1024, MEMORY_TAG_ENTITY);
+//     u64 index = soa_table_push(&particles);
+//     particles.life[index] = 1.0f;
+//
+// Columns are aligned to SOA_TABLE_ALIGNMENT and padded to a multiple of it, so vector loops
+// can read whole vectors past the length without leaving the column. Column pointers change
+// when the table grows.
+
+#define SOA_TABLE_MAX_COLUMNS 16
+
+// The alignment and padding of each column, enough for the widest vector loads.
+#define SOA_TABLE_ALIGNMENT 64
+
+// Returned by soa_table_push on failure.
+#define SOA_TABLE_INVALID_INDEX 0xFFFFFFFFFFFFFFFFULL
+
+typedef struct soa_table
+{
+    u64 length;
+    u64 capacity;
+    u32 column_count;
+    memory_tag tag;
+    u64 strides[SOA_TABLE_MAX_COLUMNS];
+    // The single block holding every column.
+    void* memory;
+    u64 memory_size;
+    // The call site that created the table, to report its memory under.
+    const char* file;
+    u32 line;
+} soa_table;
+
+AAPI b8 _soa_table_create(soa_table* table, void** columns, const u64* strides, u32 column_count, u64 capacity, memory_tag tag, const char* file, u32 line);
+AAPI void _soa_table_destroy(soa_table* table, void** columns);
+AAPI b8 _soa_table_reserve(soa_table* table, void** columns, u64 capacity);
+AAPI u64 _soa_table_push(soa_table* table, void** columns);
+AAPI void _soa_table_swap_remove(soa_table* table, void** columns, u64 index);
+
+#define SOA_TABLE_COLUMN(type, name) type* name;
+#define SOA_TABLE_STRIDE(type, name) sizeof(type),
+
+/**
+ * Define a struct-of-arrays table type, with one typed column pointer per field.
+ * @param name The name of the type.
+ * @param FIELDS An X-macro listing the fields as X(type, name).
+*/
+#define soa_table_define(name, FIELDS)                                            \
+    typedef struct name                                                           \
+    {                                                                             \
+        soa_table table;                                                          \
+        union                                                                     \
+        {                                                                         \
+            struct                                                                \
+            {                                                                     \
+                FIELDS(SOA_TABLE_COLUMN)                                          \
+            };                                                                    \
+            void* columns[sizeof(struct { FIELDS(SOA_TABLE_COLUMN) }) / sizeof(void*)]; \
+        };                                                                        \
+    } name
+
+/**
+ * Create a table, allocating its columns.
+ * @param t A pointer to a table of a type defined with soa_table_define.
+ * @param FIELDS The X-macro the type was defined with.
+ * @param capacity The number of elements the table can initially store.
+ * @param tag The tag to account the columns under.
+ * @return TRUE on success; otherwise FALSE.
+*/
+#define soa_table_create(t, FIELDS, capacity, tag)                                      \
+    _soa_table_create(&(t)->table, (t)->columns, (const u64[]){FIELDS(SOA_TABLE_STRIDE)}, \
+                      sizeof((t)->columns) / sizeof(void*), capacity, tag, __FILE__, __LINE__)
+
+/**
+ * Destroy a table, freeing its columns.
+*/
+#define soa_table_destroy(t) \
+    _soa_table_destroy(&(t)->table, (t)->columns)
+
+/**
+ * Make sure the table can hold capacity elements without growing.
+ * @return TRUE on success; otherwise FALSE.
+*/
+#define soa_table_reserve(t, capacity) \
+    _soa_table_reserve(&(t)->table, (t)->columns, capacity)
+
+/**
+ * Append an element, growing the table if needed. The fields of the element are NOT
+ * initialized.
+ * @return The index of the element, or SOA_TABLE_INVALID_INDEX on failure.
+*/
+#define soa_table_push(t) \
+    _soa_table_push(&(t)->table, (t)->columns)
+
+/**
+ * Remove an element by moving the last element in its place, in every column.
+ * Doesn't preserve the order of the elements.
+*/
+#define soa_table_swap_remove(t, index) \
+    _soa_table_swap_remove(&(t)->table, (t)->columns, index)
+
+#define soa_table_length(t) \
+    ((t)->table.length)
+
+#define soa_table_capacity(t) \
+    ((t)->table.capacity)
+
+#define soa_table_clear(t) \
+    ((t)->table.length = 0)
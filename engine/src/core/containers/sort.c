@@ -0,0 +1,317 @@
+#include "sort.h"
+
+#include "core/logger.h"
+#include "core/amemory.h"
+
+// Ranges this small are finished with an insertion sort. Can be defined by the build to
+// re-tune it with the sort benchmark.
+#ifndef SORT_INSERTION_THRESHOLD
+#define SORT_INSERTION_THRESHOLD 16
+#endif
+
+// Radix sorts of fewer elements than this take an insertion sort instead, which is stable
+// too and doesn't pay for the histograms. Can be defined by the build like the above.
+#ifndef SORT_RADIX_MIN_COUNT
+#define SORT_RADIX_MIN_COUNT 64
+#endif
+
+#define ELEMENT(base, index, stride) ((u8*)(base) + (index) * (stride))
+
+// Swap two elements 8 bytes at a time, so no temporary element of unknown size is needed.
+static void swap_elements(u8* a, u8* b, u64 stride)
+{
+    if (a == b)
+    {
+        return;
+    }
+
+    for (; stride >= sizeof(u64); stride -= sizeof(u64), a += sizeof(u64), b += sizeof(u64))
+    {
+        u64 temp;
+        __builtin_memcpy(&temp, a, sizeof(u64));
+        __builtin_memcpy(a, b, sizeof(u64));
+        __builtin_memcpy(b, &temp, sizeof(u64));
+    }
+    for (; stride > 0; --stride, ++a, ++b)
+    {
+        u8 temp = *a;
+        *a = *b;
+        *b = temp;
+    }
+}
+
+static void insertion_sort(u8* elements, u64 count, u64 stride, PFN_compare compare)
+{
+    for (u64 i = 1; i < count; ++i)
+    {
+        for (u64 j = i; j > 0; --j)
+        {
+            u8* current = ELEMENT(elements, j, stride);
+            u8* previous = current - stride;
+            if (compare(previous, current) <= 0)
+            {
+                break;
+            }
+            swap_elements(previous, current, stride);
+        }
+    }
+}
+
+static void sift_down(u8* elements, u64 root, u64 count, u64 stride, PFN_compare compare)
+{
+    for (;;)
+    {
+        u64 child = root * 2 + 1;
+        if (child >= count)
+        {
+            return;
+        }
+        if (child + 1 < count && compare(ELEMENT(elements, child, stride), ELEMENT(elements, child + 1, stride)) < 0)
+        {
+            child++;
+        }
+        if (compare(ELEMENT(elements, root, stride), ELEMENT(elements, child, stride)) >= 0)
+        {
+            return;
+        }
+        swap_elements(ELEMENT(elements, root, stride), ELEMENT(elements, child, stride), stride);
+        root = child;
+    }
+}
+
+static void heap_sort(u8* elements, u64 count, u64 stride, PFN_compare compare)
+{
+    for (u64 i = count / 2; i > 0; --i)
+    {
+        sift_down(elements, i - 1, count, stride, compare);
+    }
+    for (u64 end = count - 1; end > 0; --end)
+    {
+        swap_elements(elements, ELEMENT(elements, end, stride), stride);
+        sift_down(elements, 0, end, stride, compare);
+    }
+}
+
+// Move the median of the first, middle and last elements to the front, as the pivot.
+static void median_of_three_to_front(u8* elements, u64 count, u64 stride, PFN_compare compare)
+{
+    u8* first = elements;
+    u8* middle = ELEMENT(elements, count / 2, stride);
+    u8* last = ELEMENT(elements, count - 1, stride);
+
+    if (compare(middle, first) < 0)
+    {
+        swap_elements(middle, first, stride);
+    }
+    if (compare(last, middle) < 0)
+    {
+        swap_elements(last, middle, stride);
+        if (compare(middle, first) < 0)
+        {
+            swap_elements(middle, first, stride);
+        }
+    }
+
+    // first <= middle <= last: the median goes to the front.
+    swap_elements(first, middle, stride);
+}
+
+static void introsort(u8* elements, u64 count, u64 stride, PFN_compare compare, u32 depth_limit)
+{
+    while (count > SORT_INSERTION_THRESHOLD)
+    {
+        if (depth_limit == 0)
+        {
+            // Too many bad pivots, heapsort keeps the worst case at O(n log n).
+            heap_sort(elements, count, stride, compare);
+            return;
+        }
+        depth_limit--;
+
+        median_of_three_to_front(elements, count, stride, compare);
+
+        // Hoare partition around the pivot at the front. Stopping on equal elements keeps
+        // ranges of duplicates balanced.
+        u64 i = 0;
+        u64 j = count;
+        for (;;)
+        {
+            do
+            {
+                i++;
+            } while (i < count && compare(ELEMENT(elements, i, stride), elements) < 0);
+            do
+            {
+                j--;
+            } while (compare(elements, ELEMENT(elements, j, stride)) < 0);
+
+            if (i >= j)
+            {
+                break;
+            }
+            swap_elements(ELEMENT(elements, i, stride), ELEMENT(elements, j, stride), stride);
+        }
+        swap_elements(elements, ELEMENT(elements, j, stride), stride);
+
+        // Recurse into the smaller side and loop on the larger one, bounding the stack depth.
+        u64 left_count = j;
+        u8* right = ELEMENT(elements, j + 1, stride);
+        u64 right_count = count - j - 1;
+        if (left_count < right_count)
+        {
+            introsort(elements, left_count, stride, compare, depth_limit);
+            elements = right;
+            count = right_count;
+        }
+        else
+        {
+            introsort(right, right_count, stride, compare, depth_limit);
+            count = left_count;
+        }
+    }
+
+    insertion_sort(elements, count, stride, compare);
+}
+
+void sort_elements(void* elements, u64 count, u64 stride, PFN_compare compare)
+{
+    if (!elements || count < 2 || stride == 0 || !compare)
+    {
+        return;
+    }
+
+    u32 depth_limit = 0;
+    for (u64 n = count; n > 1; n >>= 1)
+    {
+        depth_limit += 2;
+    }
+
+    introsort(elements, count, stride, compare, depth_limit);
+}
+
+// An LSD radix sort over one byte per pass. A single pass over the input builds the histogram
+// of every byte at once, and a pass is skipped when all elements share the same byte.
+// The elements ping-pong between the input and the scratch buffer, and are copied back at
+// the end if the last pass left them in the scratch buffer.
+#define RADIX_SORT_IMPL(name, type, key_type, KEY)                                              \
+    void name(type* elements, u64 count, type* scratch)                                         \
+    {                                                                                           \
+        if (!elements || count < 2)                                                             \
+        {                                                                                       \
+            return;                                                                             \
+        }                                                                                       \
+                                                                                                \
+        if (count < SORT_RADIX_MIN_COUNT)                                                       \
+        {                                                                                       \
+            for (u64 i = 1; i < count; ++i)                                                     \
+            {                                                                                   \
+                type element = elements[i];                                                     \
+                u64 j = i;                                                                      \
+                for (; j > 0 && KEY(elements[j - 1]) > KEY(element); --j)                       \
+                {                                                                               \
+                    elements[j] = elements[j - 1];                                              \
+                }                                                                               \
+                elements[j] = element;                                                          \
+            }                                                                                   \
+            return;                                                                             \
+        }                                                                                       \
+                                                                                                \
+        type* buffer = scratch;                                                                 \
+        if (!buffer)                                                                            \
+        {                                                                                       \
+            buffer = aallocate_uninit(count * sizeof(type), MEMORY_TAG_ARRAY);                  \
+            if (!buffer)                                                                        \
+            {                                                                                   \
+                AERROR(#name " - Failed to allocate a scratch buffer of %llu elements.", count); \
+                return;                                                                         \
+            }                                                                                   \
+        }                                                                                       \
+                                                                                                \
+        u64 histograms[sizeof(key_type)][256] = {0};                                            \
+        for (u64 i = 0; i < count; ++i)                                                         \
+        {                                                                                       \
+            key_type key = KEY(elements[i]);                                                    \
+            for (u32 d = 0; d < sizeof(key_type); ++d)                                          \
+            {                                                                                   \
+                histograms[d][(key >> (d * 8)) & 0xFF]++;                                       \
+            }                                                                                   \
+        }                                                                                       \
+                                                                                                \
+        type* source = elements;                                                                \
+        type* dest = buffer;                                                                    \
+        for (u32 d = 0; d < sizeof(key_type); ++d)                                              \
+        {                                                                                       \
+            u32 shift = d * 8;                                                                  \
+            u64* histogram = histograms[d];                                                     \
+            if (histogram[(KEY(source[0]) >> shift) & 0xFF] == count)                           \
+            {                                                                                   \
+                continue;                                                                       \
+            }                                                                                   \
+                                                                                                \
+            u64 offset = 0;                                                                     \
+            for (u32 b = 0; b < 256; ++b)                                                       \
+            {                                                                                   \
+                u64 bucket_count = histogram[b];                                                \
+                histogram[b] = offset;                                                          \
+                offset += bucket_count;                                                         \
+            }                                                                                   \
+                                                                                                \
+            for (u64 i = 0; i < count; ++i)                                                     \
+            {                                                                                   \
+                dest[histogram[(KEY(source[i]) >> shift) & 0xFF]++] = source[i];                \
+            }                                                                                   \
+                                                                                                \
+            type* temp = source;                                                                \
+            source = dest;                                                                      \
+            dest = temp;                                                                        \
+        }                                                                                       \
+                                                                                                \
+        if (source != elements)                                                                 \
+        {                                                                                       \
+            acopy_memory(elements, source, count * sizeof(type));                               \
+        }                                                                                       \
+                                                                                                \
+        if (!scratch)                                                                           \
+        {                                                                                       \
+            afree(buffer, count * sizeof(type), MEMORY_TAG_ARRAY);                              \
+        }                                                                                       \
+    }
+
+#define KEY_SELF(element) (element)
+#define KEY_FIELD(element) ((element).key)
+
+RADIX_SORT_IMPL(sort_radix_u32, u32, u32, KEY_SELF)
+RADIX_SORT_IMPL(sort_radix_u64, u64, u64, KEY_SELF)
+RADIX_SORT_IMPL(sort_radix_pairs_u32, sort_pair_u32, u32, KEY_FIELD)
+RADIX_SORT_IMPL(sort_radix_pairs_u64, sort_pair_u64, u64, KEY_FIELD)
+
+u64 sort_lower_bound(const void* elements, u64 count, u64 stride, const void* key, PFN_compare compare)
+{
+    u64 first = 0;
+    while (count > 0)
+    {
+        u64 half = count / 2;
+        if (compare(ELEMENT(elements, first + half, stride), key) < 0)
+        {
+            first += half + 1;
+            count -= half + 1;
+        }
+        else
+        {
+            count = half;
+        }
+    }
+
+    return first;
+}
+
+u64 sort_binary_search(const void* elements, u64 count, u64 stride, const void* key, PFN_compare compare)
+{
+    u64 index = sort_lower_bound(elements, count, stride, key, compare);
+    if (index < count && compare(ELEMENT(elements, index, stride), key) == 0)
+    {
+        return index;
+    }
+
+    return SORT_NOT_FOUND;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "defines.h"
+#include "core/containers/darray.h"
+
+// Returned by sort_binary_search when the key isn't found.
+#define SORT_NOT_FOUND 0xFFFFFFFFFFFFFFFFULL
+
+/**
+ * Compare two elements.
+ * @return A negative value if a orders before b, 0 if they are equal; otherwise a positive value.
+ */
+typedef i32 (*PFN_compare)(const void* a, const void* b);
+
+// A key and its payload, sorted by key. Used to sort indices or handles by a computed key.
+typedef struct sort_pair_u32
+{
+    u32 key;
+    u32 value;
+} sort_pair_u32;
+
+typedef struct sort_pair_u64
+{
+    u64 key;
+    u64 value;
+} sort_pair_u64;
+
+/**
+ * Sort elements of any size with an introsort: quicksort falling back to heapsort on bad
+ * pivots, and to insertion sort on small ranges. O(n log n) worst case, NOT stable.
+ * @param elements A pointer to the first element.
+ * @param count The number of elements.
+ * @param stride The size of each element, in bytes.
+ * @param compare The function ordering two elements.
+ */
+AAPI void sort_elements(void* elements, u64 count, u64 stride, PFN_compare compare);
+
+/**
+ * Sort keys in ascending order with an LSD radix sort, one byte per pass. Passes where every
+ * key has the same byte are skipped. Stable, O(n), but needs a buffer as large as the keys.
+ * Short inputs are insertion sorted instead, without touching the buffer.
+ * @param keys A pointer to the keys.
+ * @param count The number of keys.
+ * @param scratch A buffer of count keys, or 0/NULL to allocate one temporarily.
+ */
+AAPI void sort_radix_u32(u32* keys, u64 count, u32* scratch);
+AAPI void sort_radix_u64(u64* keys, u64 count, u64* scratch);
+
+/**
+ * Sort pairs by key in ascending order with an LSD radix sort. Pairs with equal keys keep
+ * their order.
+ * @param pairs A pointer to the pairs.
+ * @param count The number of pairs.
+ * @param scratch A buffer of count pairs, or 0/NULL to allocate one temporarily.
+ */
+AAPI void sort_radix_pairs_u32(sort_pair_u32* pairs, u64 count, sort_pair_u32* scratch);
+AAPI void sort_radix_pairs_u64(sort_pair_u64* pairs, u64 count, sort_pair_u64* scratch);
+
+/**
+ * Find the first element not ordered before the key, in elements sorted by compare.
+ * @param elements A pointer to the first element.
+ * @param count The number of elements.
+ * @param stride The size of each element, in bytes.
+ * @param key A pointer to the key, compared as the second argument of compare.
+ * @param compare The function the elements are sorted by.
+ * @return The index of the first element >= key, count if there is none.
+ */
+AAPI u64 sort_lower_bound(const void* elements, u64 count, u64 stride, const void* key, PFN_compare compare);
+
+/**
+ * Find an element equal to the key, in elements sorted by compare.
+ * @param elements A pointer to the first element.
+ * @param count The number of elements.
+ * @param stride The size of each element, in bytes.
+ * @param key A pointer to the key, compared as the second argument of compare.
+ * @param compare The function the elements are sorted by.
+ * @return The index of the first equal element, SORT_NOT_FOUND if there is none.
+ */
+AAPI u64 sort_binary_search(const void* elements, u64 count, u64 stride, const void* key, PFN_compare compare);
+
+/**
+ * Sort the elements of a dynamic array with sort_elements.
+ * @param array A pointer to the dynamic array.
+ * @param compare The function ordering two elements.
+*/
+#define darray_sort(array, compare) \
+    sort_elements(array, darray_length(array), darray_stride(array), compare)
+
+/**
+ * Sort a dynamic array of u32, u64, sort_pair_u32 or sort_pair_u64 with the radix sort.
+ * @param array A pointer to the dynamic array.
+*/
+#define darray_sort_radix(array)                                            \
+    _Generic((array),                                                       \
+        u32*: sort_radix_u32,                                               \
+        u64*: sort_radix_u64,                                               \
+        sort_pair_u32*: sort_radix_pairs_u32,                               \
+        sort_pair_u64*: sort_radix_pairs_u64)(array, darray_length(array), 0)
+
+/**
+ * Find the first element of a sorted dynamic array not ordered before the key.
+ * @return The index of the element, the length of the array if there is none.
+*/
+#define darray_lower_bound(array, key_ptr, compare) \
+    sort_lower_bound(array, darray_length(array), darray_stride(array), key_ptr, compare)
+
+/**
+ * Find an element equal to the key in a sorted dynamic array.
+ * @return The index of the element, SORT_NOT_FOUND if there is none.
+*/
+#define darray_binary_search(array, key_ptr, compare) \
+    sort_binary_search(array, darray_length(array), darray_stride(array), key_ptr, compare)
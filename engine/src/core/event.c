@@ -114,9 +114,8 @@ b8 event_unregister(u16 code, void *listener, PFN_on_event on_event)
         registered_event e = state.registered[code].events[i];
         if (e.listener == listener && e.callback == on_event)
         {
-            // Found one, remote it.
-            registered_event popped_event;
-            darray_pop_at(state.registered[code].events, i, &popped_event);
+            // Found one, remove it. Listeners keep their order, the first ones get to handle events first.
+            darray_pop_at(state.registered[code].events, i, 0);
 
             return TRUE;
         }
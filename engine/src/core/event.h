@@ -105,5 +105,13 @@ typedef enum system_event_code
     // u16 height = data.data.u16[1];
     EVENT_CODE_RESIZED = 0x08,
 
+    // A memory tag crossed one of its budgets, see memory_set_tag_budget.
+    // Fired once per crossing, from memory_end_frame.
+    // Context usage :
+    // u32 tag = data.data.u32[0];
+    // u32 level = data.data.u32[1]; (memory_budget_level)
+    // u64 allocated = data.data.u64[1];
+    EVENT_CODE_MEMORY_BUDGET_EXCEEDED = 0x09,
+
     MAX_EVENT_CODE = 0xFF
 } system_event_code;
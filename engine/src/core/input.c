@@ -2,18 +2,23 @@
 #include "core/event.h"
 #include "core/amemory.h"
 #include "core/logger.h"
+#include "core/containers/bitset.h"
 #include "input.h"
 
+STATIC_ASSERT( KEYS_MAX_KEYS <= 256, "Expected every key to fit in a bitset256." );
+STATIC_ASSERT( MOUSE_BUTTON_MAX_BUTTONS <= 64, "Expected every mouse button to fit in a bitset64." );
+
 typedef struct keyboard_state
 {
-    b8 keys[256];
+    // One bit per key, set while the key is down.
+    bitset256 keys;
 } keyboard_state;
 
 typedef struct mouse_state
 {
     i16 x;
     i16 y;
-    b8 buttons[MOUSE_BUTTON_MAX_BUTTONS];
+    bitset64 buttons;
 } mouse_state;
 
 typedef struct input_state
@@ -57,10 +62,17 @@ void update_inputs( f64 delta_time )
 void input_process_key( keys key, b8 pressed )
 {
     // Only handle this if the state actually changed.
-    if( state.keyboard_current.keys[key] != pressed )
+    if( bitset_fixed_test( &state.keyboard_current.keys, key ) != ( pressed != FALSE ) )
     {
         // Update internal state.
-        state.keyboard_current.keys[key] = pressed;
+        if( pressed )
+        {
+            bitset_fixed_set( &state.keyboard_current.keys, key );
+        }
+        else
+        {
+            bitset_fixed_clear( &state.keyboard_current.keys, key );
+        }
 
         // Fire off an event for immediate processing.
         event_context context;
@@ -74,9 +86,16 @@ void input_process_key( keys key, b8 pressed )
 void input_process_mouse_button( mouse_buttons button, b8 pressed )
 {
     // If the state changed, fire an event.
-    if( state.mouse_current.buttons[button] != pressed )
+    if( bitset_fixed_test( &state.mouse_current.buttons, button ) != ( pressed != FALSE ) )
     {
-        state.mouse_current.buttons[button] = pressed;
+        if( pressed )
+        {
+            bitset_fixed_set( &state.mouse_current.buttons, button );
+        }
+        else
+        {
+            bitset_fixed_clear( &state.mouse_current.buttons, button );
+        }
 
         // Fire the event.
         event_context context;
@@ -126,7 +145,7 @@ b8 input_is_key_down( keys key )
         return FALSE;
     }
 
-    return state.keyboard_current.keys[key] == TRUE;
+    return bitset_fixed_test( &state.keyboard_current.keys, key );
 }
 
 b8 input_is_key_up( keys key )
@@ -136,7 +155,7 @@ b8 input_is_key_up( keys key )
         return FALSE;
     }
 
-    return state.keyboard_current.keys[key] == FALSE;
+    return !bitset_fixed_test( &state.keyboard_current.keys, key );
 }
 
 b8 input_was_key_down( keys key )
@@ -146,7 +165,7 @@ b8 input_was_key_down( keys key )
         return FALSE;
     }
 
-    return state.keyboard_previous.keys[key] == TRUE;
+    return bitset_fixed_test( &state.keyboard_previous.keys, key );
 }
 
 b8 input_was_key_up( keys key )
@@ -156,7 +175,7 @@ b8 input_was_key_up( keys key )
         return FALSE;
     }
 
-    return state.keyboard_previous.keys[key] == FALSE;
+    return !bitset_fixed_test( &state.keyboard_previous.keys, key );
 }
 
 b8 input_is_mouse_button_down( mouse_buttons button )
@@ -166,7 +185,7 @@ b8 input_is_mouse_button_down( mouse_buttons button )
         return FALSE;
     }
 
-    return state.mouse_current.buttons[button] == TRUE;
+    return bitset_fixed_test( &state.mouse_current.buttons, button );
 }
 
 b8 input_is_mouse_button_up( mouse_buttons button )
@@ -176,7 +195,7 @@ b8 input_is_mouse_button_up( mouse_buttons button )
         return FALSE;
     }
 
-    return state.mouse_current.buttons[button] == FALSE;
+    return !bitset_fixed_test( &state.mouse_current.buttons, button );
 }
 
 b8 input_was_mouse_button_down( mouse_buttons button )
@@ -186,7 +205,7 @@ b8 input_was_mouse_button_down( mouse_buttons button )
         return FALSE;
     }
 
-    return state.mouse_previous.buttons[button] == TRUE;
+    return bitset_fixed_test( &state.mouse_previous.buttons, button );
 }
 
 b8 input_was_mouse_button_up( mouse_buttons button )
@@ -196,7 +215,7 @@ b8 input_was_mouse_button_up( mouse_buttons button )
         return FALSE;
     }
 
-    return state.mouse_previous.buttons[button] == FALSE;
+    return !bitset_fixed_test( &state.mouse_previous.buttons, button );
 }
 
 void input_get_mouse_position( i32 *x, i32 *y )
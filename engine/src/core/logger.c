@@ -1,6 +1,7 @@
 #include "logger.h"
 #include "asserts.h"
 #include "platform/platform.h"
+#include "core/memory/scratch_allocator.h"
 
 // TODO: Temporary.
 #include <stdio.h>
@@ -31,8 +32,16 @@ void log_output(log_level level, const char* message, ...)
     // Technically imposes a 32k character limit on a single log entry, but...
     // DON'T DO THAT!
     const i32 msg_length = 32000;
-    char out_message[msg_length];
-    memset(out_message, 0, sizeof(out_message));
+    scratch_marker marker = scratch_mark();
+    char* out_message = scratch_allocate(msg_length);
+    char* out_message2 = scratch_allocate(msg_length);
+    if (!out_message || !out_message2)
+    {
+        // Out of memory, output the unformatted message rather than nothing.
+        scratch_restore(marker);
+        platform_console_write_error(message, level);
+        return;
+    }
 
     // Format original message
     // NOTE: Oddly enough, MS's headers override the GCC/Clang va_list type with a typedef char* va_list in some
@@ -44,8 +53,7 @@ void log_output(log_level level, const char* message, ...)
     vsnprintf(out_message, msg_length, message, arg_ptr);
     va_end(arg_ptr);
 
-    char out_message2[msg_length];
-    sprintf(out_message2, "%s%s\n", level_strings[level], out_message);
+    snprintf(out_message2, msg_length, "%s%s\n", level_strings[level], out_message);
 
     // Platform-specific output.
     if(is_error)
@@ -56,4 +64,6 @@ void log_output(log_level level, const char* message, ...)
     {
         platform_console_write(out_message2, level);
     }
+
+    scratch_restore(marker);
 }
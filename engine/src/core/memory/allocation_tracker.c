@@ -0,0 +1,397 @@
+#include "allocation_tracker.h"
+
+#include "core/logger.h"
+#include "platform/platform.h"
+
+// The number of call sites listed in reports.
+#define TRACKER_REPORT_SITES 5
+
+// Tables grow once they are more than 70% full.
+#define TRACKER_MAX_LOAD_NUMERATOR 7
+#define TRACKER_MAX_LOAD_DENOMINATOR 10
+
+#define TRACKER_INITIAL_CAPACITY 1024
+
+// A place in the code allocating memory, identified by its file and line.
+typedef struct call_site
+{
+    const char* file;
+    u32 line;
+    memory_tag tag;
+    u64 live_count;
+    u64 live_bytes;
+    u64 frame_count;
+    u64 frame_bytes;
+    u64 total_count;
+    u64 total_bytes;
+} call_site;
+
+typedef struct live_allocation
+{
+    // The address of the block, 0 when the slot is empty.
+    u64 block;
+    u64 size;
+    // Index of the call site in the sites array.
+    u32 site;
+} live_allocation;
+
+typedef struct allocation_tracker_state
+{
+    // Open-addressing table of live allocations keyed by address, using linear probing.
+    live_allocation* live;
+    u64 live_capacity;
+    u64 live_count;
+
+    // Every call site seen so far, never removed.
+    call_site* sites;
+    u32 site_count;
+    u32 site_capacity;
+
+    // Open-addressing table mapping a call site to its index + 1 (0 when empty).
+    u32* site_lookup;
+    u32 site_lookup_capacity;
+} allocation_tracker_state;
+
+static b8 is_initialized = FALSE;
+static allocation_tracker_state state;
+
+static u64 hash_u64(u64 value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+static u64 site_hash(const char* file, u32 line)
+{
+    return hash_u64((u64)file ^ ((u64)line << 48));
+}
+
+static void live_insert(live_allocation entry)
+{
+    u64 mask = state.live_capacity - 1;
+    u64 slot = hash_u64(entry.block) & mask;
+    while (state.live[slot].block != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    state.live[slot] = entry;
+}
+
+static void live_grow()
+{
+    live_allocation* old_live = state.live;
+    u64 old_capacity = state.live_capacity;
+
+    state.live_capacity = old_capacity ? old_capacity * 2 : TRACKER_INITIAL_CAPACITY;
+    state.live = platform_allocate_zeroed(state.live_capacity * sizeof(live_allocation));
+
+    for (u64 i = 0; i < old_capacity; ++i)
+    {
+        if (old_live[i].block)
+        {
+            live_insert(old_live[i]);
+        }
+    }
+
+    platform_free(old_live, FALSE);
+}
+
+static void site_lookup_insert(u32 index)
+{
+    u32 mask = state.site_lookup_capacity - 1;
+    u32 slot = site_hash(state.sites[index].file, state.sites[index].line) & mask;
+    while (state.site_lookup[slot] != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    state.site_lookup[slot] = index + 1;
+}
+
+static u32 find_or_add_site(const char* file, u32 line, memory_tag tag)
+{
+    u32 mask = state.site_lookup_capacity - 1;
+    u32 slot = site_hash(file, line) & mask;
+    while (state.site_lookup[slot] != 0)
+    {
+        call_site* site = &state.sites[state.site_lookup[slot] - 1];
+        if (site->file == file && site->line == line)
+        {
+            return state.site_lookup[slot] - 1;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    // New call site.
+    if (state.site_count == state.site_capacity)
+    {
+        u32 new_capacity = state.site_capacity * 2;
+        call_site* new_sites = platform_allocate_zeroed(new_capacity * sizeof(call_site));
+        platform_copy_memory(new_sites, state.sites, state.site_count * sizeof(call_site));
+        platform_free(state.sites, FALSE);
+        state.sites = new_sites;
+        state.site_capacity = new_capacity;
+    }
+
+    u32 index = state.site_count++;
+    call_site* site = &state.sites[index];
+    site->file = file;
+    site->line = line;
+    site->tag = tag;
+    state.site_lookup[slot] = index + 1;
+
+    // Keep the lookup table sparse.
+    if (state.site_count * TRACKER_MAX_LOAD_DENOMINATOR > state.site_lookup_capacity * TRACKER_MAX_LOAD_NUMERATOR)
+    {
+        platform_free(state.site_lookup, FALSE);
+        state.site_lookup_capacity *= 2;
+        state.site_lookup = platform_allocate_zeroed(state.site_lookup_capacity * sizeof(u32));
+        for (u32 i = 0; i < state.site_count; ++i)
+        {
+            site_lookup_insert(i);
+        }
+    }
+
+    return index;
+}
+
+void allocation_tracker_initialize()
+{
+    if (is_initialized)
+    {
+        return;
+    }
+
+    platform_zero_memory(&state, sizeof(state));
+    live_grow();
+
+    state.site_capacity = TRACKER_INITIAL_CAPACITY;
+    state.sites = platform_allocate_zeroed(state.site_capacity * sizeof(call_site));
+    state.site_lookup_capacity = TRACKER_INITIAL_CAPACITY;
+    state.site_lookup = platform_allocate_zeroed(state.site_lookup_capacity * sizeof(u32));
+
+    is_initialized = TRUE;
+}
+
+void allocation_tracker_shutdown()
+{
+    if (!is_initialized)
+    {
+        return;
+    }
+
+    if (state.live_count)
+    {
+        u64 leaked_bytes = 0;
+        for (u32 i = 0; i < state.site_count; ++i)
+        {
+            call_site* site = &state.sites[i];
+            if (site->live_count)
+            {
+                AWARN(
+                    "Leak: %llu allocation(s), %lluB (%s) from %s:%u",
+                    site->live_count,
+                    site->live_bytes,
+                    memory_tag_name(site->tag),
+                    site->file,
+                    site->line);
+                leaked_bytes += site->live_bytes;
+            }
+        }
+
+        AWARN("%llu allocation(s) totalling %lluB were never freed.", state.live_count, leaked_bytes);
+    }
+
+    platform_free(state.live, FALSE);
+    platform_free(state.sites, FALSE);
+    platform_free(state.site_lookup, FALSE);
+    platform_zero_memory(&state, sizeof(state));
+    is_initialized = FALSE;
+}
+
+void allocation_tracker_add(void* block, u64 size, memory_tag tag, const char* file, u32 line)
+{
+    if (!is_initialized || !block)
+    {
+        return;
+    }
+
+    if ((state.live_count + 1) * TRACKER_MAX_LOAD_DENOMINATOR > state.live_capacity * TRACKER_MAX_LOAD_NUMERATOR)
+    {
+        live_grow();
+    }
+
+    u32 site_index = find_or_add_site(file, line, tag);
+    call_site* site = &state.sites[site_index];
+    site->live_count++;
+    site->live_bytes += size;
+    site->frame_count++;
+    site->frame_bytes += size;
+    site->total_count++;
+    site->total_bytes += size;
+
+    live_allocation entry = {(u64)block, size, site_index};
+    live_insert(entry);
+    state.live_count++;
+}
+
+void allocation_tracker_remove(void* block, u64 size, memory_tag tag)
+{
+    if (!is_initialized || !block)
+    {
+        return;
+    }
+
+    u64 mask = state.live_capacity - 1;
+    u64 slot = hash_u64((u64)block) & mask;
+    while (state.live[slot].block != (u64)block)
+    {
+        if (state.live[slot].block == 0)
+        {
+            AWARN("afree called on %p (%s), which is not a live allocation.", block, memory_tag_name(tag));
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    live_allocation* entry = &state.live[slot];
+    call_site* site = &state.sites[entry->site];
+    if (entry->size != size)
+    {
+        AWARN(
+            "afree called on %p with %lluB, but %lluB were allocated at %s:%u.",
+            block,
+            size,
+            entry->size,
+            site->file,
+            site->line);
+    }
+    site->live_count--;
+    site->live_bytes -= entry->size;
+
+    // Backward-shift deletion: pull following entries of the probe chain into the hole,
+    // so lookups never need tombstones.
+    u64 hole = slot;
+    u64 next = (slot + 1) & mask;
+    while (state.live[next].block != 0)
+    {
+        u64 home = hash_u64(state.live[next].block) & mask;
+        // Move the entry if its home slot isn't cyclically within (hole, next].
+        b8 home_after_hole = hole <= next ? (home > hole && home <= next) : (home > hole || home <= next);
+        if (!home_after_hole)
+        {
+            state.live[hole] = state.live[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+
+    state.live[hole].block = 0;
+    state.live_count--;
+}
+
+b8 allocation_tracker_find_site(void* block, const char** out_file, u32* out_line)
+{
+    if (!is_initialized || !block)
+    {
+        return FALSE;
+    }
+
+    u64 mask = state.live_capacity - 1;
+    u64 slot = hash_u64((u64)block) & mask;
+    while (state.live[slot].block != (u64)block)
+    {
+        if (state.live[slot].block == 0)
+        {
+            return FALSE;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    call_site* site = &state.sites[state.live[slot].site];
+    *out_file = site->file;
+    *out_line = site->line;
+    return TRUE;
+}
+
+// Log the call sites with the highest frame counters, ranked either by count or by bytes.
+static void report_top_sites(b8 by_bytes)
+{
+    u32 top[TRACKER_REPORT_SITES];
+    u32 top_count = 0;
+    for (u32 i = 0; i < state.site_count; ++i)
+    {
+        u64 value = by_bytes ? state.sites[i].frame_bytes : state.sites[i].frame_count;
+        if (value == 0)
+        {
+            continue;
+        }
+
+        // Insertion into the small sorted list of top sites.
+        u32 position = top_count < TRACKER_REPORT_SITES ? top_count++ : TRACKER_REPORT_SITES;
+        while (position > 0)
+        {
+            call_site* previous = &state.sites[top[position - 1]];
+            u64 previous_value = by_bytes ? previous->frame_bytes : previous->frame_count;
+            if (previous_value >= value)
+            {
+                break;
+            }
+            if (position < TRACKER_REPORT_SITES)
+            {
+                top[position] = top[position - 1];
+            }
+            position--;
+        }
+        if (position < TRACKER_REPORT_SITES)
+        {
+            top[position] = i;
+        }
+    }
+
+    ADEBUG("Top allocating call sites this frame, by %s:", by_bytes ? "bytes" : "count");
+    for (u32 i = 0; i < top_count; ++i)
+    {
+        call_site* site = &state.sites[top[i]];
+        ADEBUG(
+            "  %llu allocation(s), %lluB (%s) from %s:%u",
+            site->frame_count,
+            site->frame_bytes,
+            memory_tag_name(site->tag),
+            site->file,
+            site->line);
+    }
+}
+
+void allocation_tracker_end_frame()
+{
+    if (!is_initialized)
+    {
+        return;
+    }
+
+    b8 allocated = FALSE;
+    for (u32 i = 0; i < state.site_count && !allocated; ++i)
+    {
+        allocated = state.sites[i].frame_count != 0;
+    }
+
+    if (!allocated)
+    {
+        return;
+    }
+
+    report_top_sites(FALSE);
+    report_top_sites(TRUE);
+
+    for (u32 i = 0; i < state.site_count; ++i)
+    {
+        state.sites[i].frame_count = 0;
+        state.sites[i].frame_bytes = 0;
+    }
+}
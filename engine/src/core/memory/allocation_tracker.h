@@ -0,0 +1,22 @@
+#pragma once
+
+#include "defines.h"
+#include "core/amemory.h"
+
+// Records every live allocation with the call site that made it, to report leaks
+// and per-frame allocation churn. Used by the memory subsystem in tracking builds.
+// NOTE: Not thread-safe, the memory subsystem serializes every call.
+
+void allocation_tracker_initialize();
+
+// Report every allocation still alive, grouped by call site, then release the tracker.
+void allocation_tracker_shutdown();
+
+void allocation_tracker_add(void* block, u64 size, memory_tag tag, const char* file, u32 line);
+void allocation_tracker_remove(void* block, u64 size, memory_tag tag);
+
+// Find the call site that allocated a live block. Returns FALSE if the block isn't tracked.
+b8 allocation_tracker_find_site(void* block, const char** out_file, u32* out_line);
+
+// Report the call sites that allocated the most during the frame, then reset the frame counters.
+void allocation_tracker_end_frame();
@@ -0,0 +1,108 @@
+#include "allocator.h"
+
+#include "core/logger.h"
+#include "core/memory/linear_allocator.h"
+#include "core/memory/pool_allocator.h"
+
+static void* general_allocate(void* state, u64 size, memory_tag tag)
+{
+    return aallocate_uninit(size, tag);
+}
+
+static void* general_reallocate(void* state, void* block, u64 old_size, u64 new_size, memory_tag tag)
+{
+    // No call site given, the grown block stays reported where it was allocated.
+    return _areallocate(block, old_size, new_size, tag, 0, 0);
+}
+
+static void general_free(void* state, void* block, u64 size, memory_tag tag)
+{
+    afree(block, size, tag);
+}
+
+static allocator general_allocator = {general_allocate, general_reallocate, general_free, 0};
+
+allocator* allocator_general()
+{
+    return &general_allocator;
+}
+
+static void* linear_allocate(void* state, u64 size, memory_tag tag)
+{
+    return linear_allocator_allocate((linear_allocator*)state, size);
+}
+
+static void* linear_reallocate(void* state, void* block, u64 old_size, u64 new_size, memory_tag tag)
+{
+    linear_allocator* linear = state;
+
+    // The last block handed out can grow or shrink in place.
+    u64 offset = (u8*)block - (u8*)linear->memory;
+    if (offset + old_size == linear->allocated && offset + new_size <= linear->total_size)
+    {
+        linear->allocated = offset + new_size;
+        if (linear->allocated > linear->high_water_mark)
+        {
+            linear->high_water_mark = linear->allocated;
+        }
+        return block;
+    }
+
+    void* new_block = linear_allocator_allocate(linear, new_size);
+    if (new_block)
+    {
+        acopy_memory(new_block, block, old_size < new_size ? old_size : new_size);
+    }
+
+    return new_block;
+}
+
+static void linear_free(void* state, void* block, u64 size, memory_tag tag)
+{
+}
+
+void allocator_from_linear(linear_allocator* linear, allocator* out_allocator)
+{
+    out_allocator->allocate = linear_allocate;
+    out_allocator->reallocate = linear_reallocate;
+    out_allocator->free = linear_free;
+    out_allocator->state = linear;
+}
+
+static void* pool_allocate(void* state, u64 size, memory_tag tag)
+{
+    pool_allocator* pool = state;
+    if (size > pool->element_size)
+    {
+        AERROR("pool allocator - %lluB doesn't fit in elements of %lluB.", size, pool->element_size);
+        return 0;
+    }
+
+    return pool_allocator_allocate(pool);
+}
+
+static void* pool_reallocate(void* state, void* block, u64 old_size, u64 new_size, memory_tag tag)
+{
+    pool_allocator* pool = state;
+    if (new_size > pool->element_size)
+    {
+        AERROR("pool allocator - %lluB doesn't fit in elements of %lluB.", new_size, pool->element_size);
+        return 0;
+    }
+
+    // Every element has the same size, the block already fits.
+    return block;
+}
+
+static void pool_free(void* state, void* block, u64 size, memory_tag tag)
+{
+    pool_allocator_free((pool_allocator*)state, block);
+}
+
+void allocator_from_pool(pool_allocator* pool, allocator* out_allocator)
+{
+    out_allocator->allocate = pool_allocate;
+    out_allocator->reallocate = pool_reallocate;
+    out_allocator->free = pool_free;
+    out_allocator->state = pool;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "defines.h"
+#include "core/amemory.h"
+
+struct linear_allocator;
+struct pool_allocator;
+
+/**
+ * A generic allocator interface, so containers can take their memory from the heap,
+ * an arena or a pool. The interface doesn't own the allocator behind it, which must
+ * outlive every block it hands out.
+ */
+typedef struct allocator
+{
+    // Allocate size bytes, NOT zeroed. Returns 0/NULL on failure.
+    void* (*allocate)(void* state, u64 size, memory_tag tag);
+    // Resize a block, keeping its contents. Returns 0/NULL on failure, leaving the block untouched.
+    void* (*reallocate)(void* state, void* block, u64 old_size, u64 new_size, memory_tag tag);
+    // Free a block. Does nothing for allocators that reclaim memory all at once.
+    void (*free)(void* state, void* block, u64 size, memory_tag tag);
+    // The allocator behind the interface.
+    void* state;
+} allocator;
+
+/**
+ * Retrieve the general purpose allocator, backed by aallocate/afree.
+ * @return A pointer to the general purpose allocator.
+ */
+AAPI allocator* allocator_general();
+
+/**
+ * Create an allocator interface over a linear allocator. Freeing does nothing, memory is
+ * reclaimed with linear_allocator_free_all. The last block can grow in place.
+ * @param linear A pointer to the linear allocator.
+ * @param out_allocator A pointer to the interface to initialize.
+ */
+AAPI void allocator_from_linear(struct linear_allocator* linear, allocator* out_allocator);
+
+/**
+ * Create an allocator interface over a pool allocator. Blocks larger than the element
+ * size of the pool can't be allocated.
+ * @param pool A pointer to the pool allocator.
+ * @param out_allocator A pointer to the interface to initialize.
+ */
+AAPI void allocator_from_pool(struct pool_allocator* pool, allocator* out_allocator);
@@ -0,0 +1,278 @@
+#include "dynamic_allocator.h"
+
+#include "core/amemory.h"
+#include "core/logger.h"
+
+// A free block. Lives at the start of the free memory it describes.
+typedef struct free_block
+{
+    // The size of the block, in bytes, including this header.
+    u64 size;
+    struct free_block* next;
+} free_block;
+
+// Stored right before every pointer handed out, so the block can be found again on free.
+typedef struct allocation_header
+{
+    // The size of the whole block, in bytes.
+    u64 block_size;
+    // The distance between the start of the block and the pointer handed out.
+    u64 offset;
+} allocation_header;
+
+// Blocks smaller than this are not worth splitting off.
+#define MIN_BLOCK_SIZE (sizeof(allocation_header) + DYNAMIC_ALLOCATOR_DEFAULT_ALIGNMENT)
+
+static u64 align_up(u64 value, u64 alignment)
+{
+    return (value + (alignment - 1)) & ~(alignment - 1);
+}
+
+b8 dynamic_allocator_create(u64 total_size, void* memory, dynamic_allocator* out_allocator)
+{
+    if (!out_allocator)
+    {
+        AERROR("dynamic_allocator_create requires a valid pointer to out_allocator.");
+        return FALSE;
+    }
+
+    // Only whole aligned blocks are ever handed out.
+    total_size &= ~((u64)DYNAMIC_ALLOCATOR_DEFAULT_ALIGNMENT - 1);
+    if (total_size < MIN_BLOCK_SIZE)
+    {
+        AERROR("dynamic_allocator_create - total_size must be at least %lluB.", (u64)MIN_BLOCK_SIZE);
+        return FALSE;
+    }
+
+    out_allocator->owns_memory = memory == 0;
+    if (!memory)
+    {
+        memory = aallocate_uninit(total_size, MEMORY_TAG_DYNAMIC_ALLOCATOR);
+    }
+
+    if (!memory || ((u64)memory & (DYNAMIC_ALLOCATOR_DEFAULT_ALIGNMENT - 1)) != 0)
+    {
+        AERROR("dynamic_allocator_create - memory block is missing or misaligned.");
+        return FALSE;
+    }
+
+    out_allocator->total_size = total_size;
+    out_allocator->free_size = total_size;
+    out_allocator->free_block_count = 1;
+    out_allocator->memory = memory;
+
+    free_block* block = memory;
+    block->size = total_size;
+    block->next = 0;
+    out_allocator->free_list = block;
+
+    return TRUE;
+}
+
+void dynamic_allocator_destroy(dynamic_allocator* allocator)
+{
+    if (!allocator)
+    {
+        return;
+    }
+
+    if (allocator->owns_memory && allocator->memory)
+    {
+        afree(allocator->memory, allocator->total_size, MEMORY_TAG_DYNAMIC_ALLOCATOR);
+    }
+
+    allocator->memory = 0;
+    allocator->free_list = 0;
+    allocator->total_size = 0;
+    allocator->free_size = 0;
+    allocator->free_block_count = 0;
+    allocator->owns_memory = FALSE;
+}
+
+// Compute the size of the block needed to serve an allocation out of the given free block.
+static u64 block_size_for(const free_block* block, u64 size, u64 alignment)
+{
+    u64 start = (u64)block;
+    u64 user = align_up(start + sizeof(allocation_header), alignment);
+    return align_up((user - start) + size, DYNAMIC_ALLOCATOR_DEFAULT_ALIGNMENT);
+}
+
+static void* allocate_aligned(dynamic_allocator* allocator, u64 size, u64 alignment)
+{
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    // Best fit: the smallest free block that can hold the allocation.
+    free_block* best = 0;
+    free_block* best_previous = 0;
+    u64 best_required = 0;
+    free_block* previous = 0;
+    for (free_block* block = allocator->free_list; block; previous = block, block = block->next)
+    {
+        u64 required = block_size_for(block, size, alignment);
+        if (required <= block->size && (!best || block->size < best->size))
+        {
+            best = block;
+            best_previous = previous;
+            best_required = required;
+            if (block->size == required)
+            {
+                // Can't do better than an exact fit.
+                break;
+            }
+        }
+    }
+
+    if (!best)
+    {
+        return 0;
+    }
+
+    // Split off the tail if it is large enough to be useful, otherwise hand out the whole block.
+    free_block* replacement = best->next;
+    u64 block_size = best->size;
+    if (best->size - best_required >= MIN_BLOCK_SIZE)
+    {
+        free_block* tail = (free_block*)((u8*)best + best_required);
+        tail->size = best->size - best_required;
+        tail->next = best->next;
+        replacement = tail;
+        block_size = best_required;
+    }
+    else
+    {
+        allocator->free_block_count--;
+    }
+
+    if (best_previous)
+    {
+        best_previous->next = replacement;
+    }
+    else
+    {
+        allocator->free_list = replacement;
+    }
+
+    allocator->free_size -= block_size;
+
+    u64 start = (u64)best;
+    u64 user = align_up(start + sizeof(allocation_header), alignment);
+    allocation_header* header = (allocation_header*)user - 1;
+    header->block_size = block_size;
+    header->offset = user - start;
+
+    return (void*)user;
+}
+
+void* dynamic_allocator_allocate(dynamic_allocator* allocator, u64 size)
+{
+    return allocate_aligned(allocator, size, DYNAMIC_ALLOCATOR_DEFAULT_ALIGNMENT);
+}
+
+void* dynamic_allocator_allocate_aligned(dynamic_allocator* allocator, u64 size, u64 alignment)
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+    {
+        AERROR("dynamic_allocator_allocate_aligned - alignment must be a power of two, got %llu.", alignment);
+        return 0;
+    }
+
+    if (alignment < DYNAMIC_ALLOCATOR_DEFAULT_ALIGNMENT)
+    {
+        alignment = DYNAMIC_ALLOCATOR_DEFAULT_ALIGNMENT;
+    }
+
+    return allocate_aligned(allocator, size, alignment);
+}
+
+void dynamic_allocator_free(dynamic_allocator* allocator, void* block)
+{
+    if (!block)
+    {
+        return;
+    }
+
+    u8* memory_start = allocator->memory;
+    if ((u8*)block < memory_start || (u8*)block >= memory_start + allocator->total_size)
+    {
+        AERROR("dynamic_allocator_free - block %p does not belong to this allocator.", block);
+        return;
+    }
+
+    allocation_header* header = (allocation_header*)block - 1;
+    free_block* freed = (free_block*)((u8*)block - header->offset);
+    freed->size = header->block_size;
+    allocator->free_size += freed->size;
+
+    // Find where the block goes in the address-ordered list.
+    free_block* previous = 0;
+    free_block* next = allocator->free_list;
+    while (next && next < freed)
+    {
+        previous = next;
+        next = next->next;
+    }
+
+    // Coalesce with the following block.
+    if (next && (u8*)freed + freed->size == (u8*)next)
+    {
+        freed->size += next->size;
+        freed->next = next->next;
+    }
+    else
+    {
+        freed->next = next;
+        allocator->free_block_count++;
+    }
+
+    // Coalesce with the preceding block.
+    if (previous && (u8*)previous + previous->size == (u8*)freed)
+    {
+        previous->size += freed->size;
+        previous->next = freed->next;
+        allocator->free_block_count--;
+    }
+    else if (previous)
+    {
+        previous->next = freed;
+    }
+    else
+    {
+        allocator->free_list = freed;
+    }
+}
+
+// The size of the largest free block, header space included.
+static u64 largest_block_size(const dynamic_allocator* allocator)
+{
+    u64 largest = 0;
+    for (const free_block* block = allocator->free_list; block; block = block->next)
+    {
+        if (block->size > largest)
+        {
+            largest = block->size;
+        }
+    }
+
+    return largest;
+}
+
+u64 dynamic_allocator_largest_free_block(const dynamic_allocator* allocator)
+{
+    // Free blocks start aligned, a default-aligned allocation only loses its header to them.
+    u64 overhead = align_up(sizeof(allocation_header), DYNAMIC_ALLOCATOR_DEFAULT_ALIGNMENT);
+    u64 largest = largest_block_size(allocator);
+    return largest > overhead ? largest - overhead : 0;
+}
+
+f32 dynamic_allocator_fragmentation(const dynamic_allocator* allocator)
+{
+    if (allocator->free_size == 0)
+    {
+        return 0.0f;
+    }
+
+    return 1.0f - (f32)largest_block_size(allocator) / (f32)allocator->free_size;
+}
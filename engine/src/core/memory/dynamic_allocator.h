@@ -0,0 +1,86 @@
+#pragma once
+
+#include "defines.h"
+
+// Every allocation handed out by a dynamic allocator is aligned to this many bytes.
+#define DYNAMIC_ALLOCATOR_DEFAULT_ALIGNMENT 16
+
+/**
+ * A general purpose allocator serving variable-size allocations out of a single
+ * memory block. Free space is kept in an address-ordered free list; allocations
+ * use a best-fit lookup and freed blocks are coalesced with their neighbours.
+ * NOTE: Not thread-safe.
+ */
+typedef struct dynamic_allocator
+{
+    // The total size of the memory block, in bytes.
+    u64 total_size;
+    // The number of bytes currently free, including per-block overhead.
+    u64 free_size;
+    // The number of blocks in the free list.
+    u64 free_block_count;
+    // The memory block itself.
+    void* memory;
+    // Head of the address-ordered free list.
+    void* free_list;
+    // Indicates if the memory block was allocated by this allocator.
+    b8 owns_memory;
+} dynamic_allocator;
+
+/**
+ * Create a dynamic allocator.
+ * @param total_size The size of the memory block, in bytes.
+ * @param memory A memory block to use, aligned to DYNAMIC_ALLOCATOR_DEFAULT_ALIGNMENT. Can be 0/NULL,
+ * in which case the allocator allocates and owns its own block.
+ * @param out_allocator A pointer to the allocator to initialize.
+ * @return TRUE on success; otherwise FALSE.
+ */
+AAPI b8 dynamic_allocator_create(u64 total_size, void* memory, dynamic_allocator* out_allocator);
+
+/**
+ * Destroy a dynamic allocator, freeing its memory block if it owns it.
+ * @param allocator A pointer to the allocator to destroy.
+ */
+AAPI void dynamic_allocator_destroy(dynamic_allocator* allocator);
+
+/**
+ * Allocate a block from a dynamic allocator. The memory is NOT zeroed.
+ * @param allocator A pointer to the allocator.
+ * @param size The number of bytes to allocate.
+ * @return A pointer to the allocated block, or 0/NULL if no free block is large enough.
+ */
+AAPI void* dynamic_allocator_allocate(dynamic_allocator* allocator, u64 size);
+
+/**
+ * Allocate a block aligned to the given boundary from a dynamic allocator. The memory is NOT zeroed.
+ * Blocks allocated this way are freed with dynamic_allocator_free.
+ * @param allocator A pointer to the allocator.
+ * @param size The number of bytes to allocate.
+ * @param alignment The alignment of the block, in bytes. Must be a power of two.
+ * @return A pointer to the allocated block, or 0/NULL if no free block is large enough.
+ */
+AAPI void* dynamic_allocator_allocate_aligned(dynamic_allocator* allocator, u64 size, u64 alignment);
+
+/**
+ * Return a block to a dynamic allocator. The block is merged with adjacent free blocks.
+ * @param allocator A pointer to the allocator.
+ * @param block A pointer to a block previously returned by this allocator.
+ */
+AAPI void dynamic_allocator_free(dynamic_allocator* allocator, void* block);
+
+/**
+ * Retrieve the largest allocation that can currently succeed with the default alignment, i.e.
+ * the size of the largest free block minus the per-block overhead.
+ * @param allocator A pointer to the allocator.
+ * @return The number of bytes, 0 if no allocation can succeed.
+ */
+AAPI u64 dynamic_allocator_largest_free_block(const dynamic_allocator* allocator);
+
+/**
+ * Retrieve the external fragmentation of the free space, defined as 1 - the size of the largest
+ * free block / free_size, both counting the per-block overhead. 0 means all the free space is
+ * contiguous.
+ * @param allocator A pointer to the allocator.
+ * @return The fragmentation, between 0 and 1.
+ */
+AAPI f32 dynamic_allocator_fragmentation(const dynamic_allocator* allocator);
@@ -0,0 +1,92 @@
+#include "linear_allocator.h"
+
+#include "core/amemory.h"
+#include "core/logger.h"
+
+void linear_allocator_create(u64 total_size, void* memory, linear_allocator* out_allocator)
+{
+    if (!out_allocator)
+    {
+        AERROR("linear_allocator_create requires a valid pointer to out_allocator.");
+        return;
+    }
+
+    out_allocator->total_size = total_size;
+    out_allocator->allocated = 0;
+    out_allocator->high_water_mark = 0;
+    out_allocator->overflow_count = 0;
+    out_allocator->owns_memory = memory == 0;
+    if (memory)
+    {
+        out_allocator->memory = memory;
+    }
+    else
+    {
+        out_allocator->memory = aallocate_uninit(total_size, MEMORY_TAG_LINEAR_ALLOCATOR);
+    }
+}
+
+void linear_allocator_destroy(linear_allocator* allocator)
+{
+    if (!allocator)
+    {
+        return;
+    }
+
+    if (allocator->owns_memory && allocator->memory)
+    {
+        afree(allocator->memory, allocator->total_size, MEMORY_TAG_LINEAR_ALLOCATOR);
+    }
+
+    allocator->memory = 0;
+    allocator->total_size = 0;
+    allocator->allocated = 0;
+    allocator->owns_memory = FALSE;
+}
+
+void* linear_allocator_allocate(linear_allocator* allocator, u64 size)
+{
+    return linear_allocator_allocate_aligned(allocator, size, LINEAR_ALLOCATOR_DEFAULT_ALIGNMENT);
+}
+
+void* linear_allocator_allocate_aligned(linear_allocator* allocator, u64 size, u64 alignment)
+{
+    if (!allocator || !allocator->memory)
+    {
+        AERROR("linear_allocator_allocate - provided allocator is not initialized.");
+        return 0;
+    }
+
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+    {
+        AERROR("linear_allocator_allocate_aligned - alignment must be a power of two, got %llu.", alignment);
+        return 0;
+    }
+
+    // Bump the address (not just the offset) to the next boundary, the block itself may be less aligned.
+    u64 base = (u64)allocator->memory;
+    u64 offset = ((base + allocator->allocated + (alignment - 1)) & ~(alignment - 1)) - base;
+    if (offset + size > allocator->total_size)
+    {
+        allocator->overflow_count++;
+        u64 remaining = allocator->total_size - allocator->allocated;
+        AERROR("linear_allocator_allocate - Tried to allocate %lluB, only %lluB remaining.", size, remaining);
+        return 0;
+    }
+
+    allocator->allocated = offset + size;
+    if (allocator->allocated > allocator->high_water_mark)
+    {
+        allocator->high_water_mark = allocator->allocated;
+    }
+
+    return (u8*)allocator->memory + offset;
+}
+
+void linear_allocator_free_all(linear_allocator* allocator)
+{
+    if (allocator)
+    {
+        allocator->allocated = 0;
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "defines.h"
+
+// Every allocation handed out by a linear allocator is aligned to this many bytes.
+#define LINEAR_ALLOCATOR_DEFAULT_ALIGNMENT 16
+
+/**
+ * A linear (bump) allocator. Memory is handed out by moving an offset forward and
+ * can only be reclaimed all at once, which makes it ideal for transient data that
+ * lives for a well-known scope (a frame, a loading step...).
+ */
+typedef struct linear_allocator
+{
+    // The total size of the memory block, in bytes.
+    u64 total_size;
+    // The number of bytes currently handed out.
+    u64 allocated;
+    // The highest value 'allocated' has reached since creation.
+    u64 high_water_mark;
+    // The number of allocations that did not fit since creation.
+    u64 overflow_count;
+    // The memory block itself.
+    void* memory;
+    // Indicates if the memory block was allocated by this allocator.
+    b8 owns_memory;
+} linear_allocator;
+
+/**
+ * Create a linear allocator.
+ * @param total_size The size of the memory block, in bytes.
+ * @param memory A memory block to use. Can be 0/NULL, in which case the allocator allocates
+ * and owns its own block.
+ * @param out_allocator A pointer to the allocator to initialize.
+ */
+AAPI void linear_allocator_create(u64 total_size, void* memory, linear_allocator* out_allocator);
+
+/**
+ * Destroy a linear allocator, freeing its memory block if it owns it.
+ * @param allocator A pointer to the allocator to destroy.
+ */
+AAPI void linear_allocator_destroy(linear_allocator* allocator);
+
+/**
+ * Allocate a block from a linear allocator. The memory is NOT zeroed.
+ * @param allocator A pointer to the allocator.
+ * @param size The number of bytes to allocate.
+ * @return A pointer to the allocated block, or 0/NULL if the allocator is out of space.
+ */
+AAPI void* linear_allocator_allocate(linear_allocator* allocator, u64 size);
+
+/**
+ * Allocate a block aligned to the given boundary from a linear allocator. The memory is NOT zeroed.
+ * @param allocator A pointer to the allocator.
+ * @param size The number of bytes to allocate.
+ * @param alignment The alignment of the block, in bytes. Must be a power of two.
+ * @return A pointer to the allocated block, or 0/NULL if the allocator is out of space.
+ */
+AAPI void* linear_allocator_allocate_aligned(linear_allocator* allocator, u64 size, u64 alignment);
+
+/**
+ * Reclaim every allocation at once. This is O(1), the memory isn't touched.
+ * @param allocator A pointer to the allocator.
+ */
+AAPI void linear_allocator_free_all(linear_allocator* allocator);
@@ -0,0 +1,182 @@
+#include "pool_allocator.h"
+
+#include "core/logger.h"
+
+// Elements are aligned to at least this many bytes, and are at least large enough to hold the free list link.
+#define POOL_ALIGNMENT 16
+
+// Each block starts with a link to the next block, padded to the alignment to keep the elements aligned.
+static u64 pool_block_size(const pool_allocator* allocator)
+{
+    return allocator->alignment + allocator->element_size * allocator->elements_per_block;
+}
+
+static b8 pool_grow(pool_allocator* allocator)
+{
+    u8* block = _aallocate_aligned(pool_block_size(allocator), allocator->alignment, allocator->tag, allocator->file, allocator->line);
+    if (!block)
+    {
+        return FALSE;
+    }
+
+    // Link the block in the list of blocks.
+    *(void**)block = allocator->blocks;
+    allocator->blocks = block;
+    allocator->block_count++;
+
+    // Thread every element of the new block on the free list, first element first.
+    u8* elements = block + allocator->alignment;
+    for (u64 i = allocator->elements_per_block; i > 0; --i)
+    {
+        void* element = elements + (i - 1) * allocator->element_size;
+        *(void**)element = allocator->free_list;
+        allocator->free_list = element;
+    }
+
+    return TRUE;
+}
+
+void _pool_allocator_create(u64 element_size, u64 elements_per_block, memory_tag tag, pool_allocator* out_allocator, const char* file, u32 line)
+{
+    if (!out_allocator)
+    {
+        AERROR("pool_allocator_create requires a valid pointer to out_allocator.");
+        return;
+    }
+
+    if (element_size < sizeof(void*))
+    {
+        element_size = sizeof(void*);
+    }
+
+    out_allocator->element_size = (element_size + (POOL_ALIGNMENT - 1)) & ~((u64)POOL_ALIGNMENT - 1);
+    out_allocator->alignment = out_allocator->element_size % ACACHE_LINE_SIZE == 0 ? ACACHE_LINE_SIZE : POOL_ALIGNMENT;
+    out_allocator->elements_per_block = elements_per_block ? elements_per_block : 1;
+    out_allocator->block_count = 0;
+    out_allocator->allocated_count = 0;
+    out_allocator->tag = tag;
+    out_allocator->free_list = 0;
+    out_allocator->blocks = 0;
+    out_allocator->file = file;
+    out_allocator->line = line;
+}
+
+void pool_allocator_destroy(pool_allocator* allocator)
+{
+    if (!allocator)
+    {
+        return;
+    }
+
+    if (allocator->allocated_count)
+    {
+        AWARN("pool_allocator_destroy - %llu elements are still in use.", allocator->allocated_count);
+        memory_report_pool_usage(allocator->tag, -(i64)(allocator->allocated_count * allocator->element_size));
+    }
+
+    u64 block_size = pool_block_size(allocator);
+    void* block = allocator->blocks;
+    while (block)
+    {
+        void* next = *(void**)block;
+        afree_aligned(block, block_size, allocator->alignment, allocator->tag);
+        block = next;
+    }
+
+    allocator->blocks = 0;
+    allocator->free_list = 0;
+    allocator->block_count = 0;
+    allocator->allocated_count = 0;
+}
+
+void* pool_allocator_allocate(pool_allocator* allocator)
+{
+    if (!allocator->free_list && !pool_grow(allocator))
+    {
+        AERROR("pool_allocator_allocate - Failed to grow the pool.");
+        return 0;
+    }
+
+    void* element = allocator->free_list;
+    allocator->free_list = *(void**)element;
+    allocator->allocated_count++;
+    memory_report_pool_usage(allocator->tag, (i64)allocator->element_size);
+
+    return element;
+}
+
+void pool_allocator_free(pool_allocator* allocator, void* element)
+{
+    if (!element)
+    {
+        return;
+    }
+
+    *(void**)element = allocator->free_list;
+    allocator->free_list = element;
+    allocator->allocated_count--;
+    memory_report_pool_usage(allocator->tag, -(i64)allocator->element_size);
+}
+
+// Return the index of the smallest size class able to hold size bytes.
+static u32 slab_size_class(u64 size)
+{
+    u32 index = 0;
+    u64 class_size = SLAB_MIN_SIZE_CLASS;
+    while (class_size < size)
+    {
+        class_size <<= 1;
+        index++;
+    }
+
+    return index;
+}
+
+void _slab_allocator_create(u64 elements_per_block, memory_tag tag, slab_allocator* out_allocator, const char* file, u32 line)
+{
+    if (!out_allocator)
+    {
+        AERROR("slab_allocator_create requires a valid pointer to out_allocator.");
+        return;
+    }
+
+    for (u32 i = 0; i < SLAB_SIZE_CLASS_COUNT; ++i)
+    {
+        _pool_allocator_create((u64)SLAB_MIN_SIZE_CLASS << i, elements_per_block, tag, &out_allocator->pools[i], file, line);
+    }
+}
+
+void slab_allocator_destroy(slab_allocator* allocator)
+{
+    if (!allocator)
+    {
+        return;
+    }
+
+    for (u32 i = 0; i < SLAB_SIZE_CLASS_COUNT; ++i)
+    {
+        pool_allocator_destroy(&allocator->pools[i]);
+    }
+}
+
+void* slab_allocator_allocate(slab_allocator* allocator, u64 size)
+{
+    if (size > SLAB_MAX_SIZE_CLASS)
+    {
+        AERROR("slab_allocator_allocate - %lluB exceeds the largest size class (%iB).", size, SLAB_MAX_SIZE_CLASS);
+        return 0;
+    }
+
+    return pool_allocator_allocate(&allocator->pools[slab_size_class(size)]);
+}
+
+void slab_allocator_free(slab_allocator* allocator, void* block, u64 size)
+{
+    if (size > SLAB_MAX_SIZE_CLASS)
+    {
+        AERROR("slab_allocator_free - %lluB exceeds the largest size class (%iB).", size, SLAB_MAX_SIZE_CLASS);
+        return;
+    }
+
+    pool_allocator_free(&allocator->pools[slab_size_class(size)], block);
+}
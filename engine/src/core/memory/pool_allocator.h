@@ -0,0 +1,119 @@
+#pragma once
+
+#include "defines.h"
+#include "core/amemory.h"
+
+/**
+ * A pool allocator hands out fixed-size elements in O(1). Free elements are chained
+ * through an intrusive free list stored inside the elements themselves. Elements are
+ * carved out of blocks; a new block is allocated when the pool runs dry, so elements
+ * already handed out never move.
+ */
+typedef struct pool_allocator
+{
+    // The size of each element, in bytes. Rounded up to the pool alignment.
+    u64 element_size;
+    // The alignment of the elements: a cache line for elements spanning whole cache lines,
+    // so none straddles an extra line; otherwise 16 bytes.
+    u64 alignment;
+    // The number of elements carved out of each block.
+    u64 elements_per_block;
+    // The number of blocks currently allocated.
+    u64 block_count;
+    // The number of elements currently handed out.
+    u64 allocated_count;
+    // The tag used for the blocks and reported for the pool usage.
+    memory_tag tag;
+    // Head of the intrusive list of free elements.
+    void* free_list;
+    // Head of the intrusive list of allocated blocks.
+    void* blocks;
+    // The call site that created the pool, to report its blocks under.
+    const char* file;
+    u32 line;
+} pool_allocator;
+
+// The size classes served by a slab allocator, in bytes.
+#define SLAB_SIZE_CLASS_COUNT 5
+#define SLAB_MIN_SIZE_CLASS 16
+#define SLAB_MAX_SIZE_CLASS 256
+
+/**
+ * A slab allocator is a set of pools, one per size class (16, 32, 64, 128 and 256 bytes).
+ * Each allocation is served from the smallest class that can hold it.
+ */
+typedef struct slab_allocator
+{
+    pool_allocator pools[SLAB_SIZE_CLASS_COUNT];
+} slab_allocator;
+
+/**
+ * Create a pool allocator. No memory is allocated until the first allocation.
+ * @param element_size The size of each element, in bytes.
+ * @param elements_per_block The number of elements to allocate at once when the pool grows.
+ * @param tag The memory tag used for this pool.
+ * @param out_allocator A pointer to the allocator to initialize.
+ */
+#define pool_allocator_create(element_size, elements_per_block, tag, out_allocator) \
+    _pool_allocator_create(element_size, elements_per_block, tag, out_allocator, __FILE__, __LINE__)
+
+AAPI void _pool_allocator_create(
+    u64 element_size,
+    u64 elements_per_block,
+    memory_tag tag,
+    pool_allocator* out_allocator,
+    const char* file,
+    u32 line);
+
+/**
+ * Destroy a pool allocator and every block it owns. Elements still in use become invalid.
+ * @param allocator A pointer to the allocator to destroy.
+ */
+AAPI void pool_allocator_destroy(pool_allocator* allocator);
+
+/**
+ * Allocate a single element from a pool. The memory is NOT zeroed.
+ * @param allocator A pointer to the allocator.
+ * @return A pointer to the element, or 0/NULL on failure.
+ */
+AAPI void* pool_allocator_allocate(pool_allocator* allocator);
+
+/**
+ * Return an element to the pool it was allocated from.
+ * @param allocator A pointer to the allocator.
+ * @param element A pointer to the element to free.
+ */
+AAPI void pool_allocator_free(pool_allocator* allocator, void* element);
+
+/**
+ * Create a slab allocator. No memory is allocated until the first allocation.
+ * @param elements_per_block The number of elements allocated at once when a size class grows.
+ * @param tag The memory tag used for this slab.
+ * @param out_allocator A pointer to the allocator to initialize.
+ */
+#define slab_allocator_create(elements_per_block, tag, out_allocator) \
+    _slab_allocator_create(elements_per_block, tag, out_allocator, __FILE__, __LINE__)
+
+AAPI void _slab_allocator_create(u64 elements_per_block, memory_tag tag, slab_allocator* out_allocator, const char* file, u32 line);
+
+/**
+ * Destroy a slab allocator and every pool it owns.
+ * @param allocator A pointer to the allocator to destroy.
+ */
+AAPI void slab_allocator_destroy(slab_allocator* allocator);
+
+/**
+ * Allocate a block of up to SLAB_MAX_SIZE_CLASS bytes. The memory is NOT zeroed.
+ * @param allocator A pointer to the allocator.
+ * @param size The number of bytes to allocate.
+ * @return A pointer to the block, or 0/NULL if size is too large.
+ */
+AAPI void* slab_allocator_allocate(slab_allocator* allocator, u64 size);
+
+/**
+ * Return a block to the slab allocator.
+ * @param allocator A pointer to the allocator.
+ * @param block A pointer to the block to free.
+ * @param size The size that was requested when allocating this block.
+ */
+AAPI void slab_allocator_free(slab_allocator* allocator, void* block, u64 size);
@@ -0,0 +1,131 @@
+#include "scratch_allocator.h"
+
+#include "platform/platform.h"
+
+// A chunk of scratch memory. The usable memory directly follows this header.
+typedef struct scratch_chunk
+{
+    struct scratch_chunk* previous;
+    struct scratch_chunk* next;
+    // The number of usable bytes in this chunk.
+    u64 size;
+    // The number of bytes currently in use in this chunk.
+    u64 used;
+    // The position of the first byte of this chunk in the whole stack.
+    u64 base;
+} AALIGN(SCRATCH_ALIGNMENT) scratch_chunk;
+
+typedef struct scratch_state
+{
+    scratch_chunk* first;
+    scratch_chunk* current;
+} scratch_state;
+
+static ATHREAD_LOCAL scratch_state state;
+
+static u64 align_up(u64 value)
+{
+    return (value + (SCRATCH_ALIGNMENT - 1)) & ~((u64)SCRATCH_ALIGNMENT - 1);
+}
+
+static scratch_chunk* create_chunk(u64 size, scratch_chunk* previous)
+{
+    // The scratch stack sits below the memory subsystem (the logger uses it), so it
+    // talks to the platform directly.
+    scratch_chunk* chunk = platform_allocate(sizeof(scratch_chunk) + size, FALSE);
+    if (!chunk)
+    {
+        return 0;
+    }
+
+    chunk->previous = previous;
+    chunk->next = 0;
+    chunk->size = size;
+    chunk->used = 0;
+    chunk->base = previous ? previous->base + previous->size : 0;
+    return chunk;
+}
+
+// Release a chunk and every chunk after it.
+static void destroy_chunks(scratch_chunk* chunk)
+{
+    while (chunk)
+    {
+        scratch_chunk* next = chunk->next;
+        platform_free(chunk, FALSE);
+        chunk = next;
+    }
+}
+
+scratch_marker scratch_mark()
+{
+    return state.current ? state.current->base + state.current->used : 0;
+}
+
+void scratch_restore(scratch_marker marker)
+{
+    scratch_chunk* chunk = state.current;
+    if (!chunk)
+    {
+        return;
+    }
+
+    // Walk back to the chunk holding the marker, emptying the chunks after it.
+    while (chunk->previous && chunk->base > marker)
+    {
+        chunk->used = 0;
+        chunk = chunk->previous;
+    }
+
+    chunk->used = marker > chunk->base ? marker - chunk->base : 0;
+    state.current = chunk;
+}
+
+void* scratch_allocate(u64 size)
+{
+    if (!state.current)
+    {
+        state.first = create_chunk(size > SCRATCH_CHUNK_SIZE ? align_up(size) : SCRATCH_CHUNK_SIZE, 0);
+        state.current = state.first;
+        if (!state.current)
+        {
+            return 0;
+        }
+    }
+
+    scratch_chunk* chunk = state.current;
+    u64 offset = align_up(chunk->used);
+    if (offset + size > chunk->size)
+    {
+        // Move on to the next chunk, replacing the rest of the chain if it's too small.
+        scratch_chunk* next = chunk->next;
+        if (!next || next->size < size)
+        {
+            destroy_chunks(next);
+            chunk->next = 0;
+            next = create_chunk(size > SCRATCH_CHUNK_SIZE ? align_up(size) : SCRATCH_CHUNK_SIZE, chunk);
+            if (!next)
+            {
+                return 0;
+            }
+            chunk->next = next;
+        }
+
+        // The tail of the current chunk is skipped, the next chunk continues the stack after it.
+        next->base = chunk->base + chunk->size;
+        next->used = 0;
+        chunk = next;
+        state.current = chunk;
+        offset = 0;
+    }
+
+    chunk->used = offset + size;
+    return (u8*)(chunk + 1) + offset;
+}
+
+void scratch_shutdown_thread()
+{
+    destroy_chunks(state.first);
+    state.first = 0;
+    state.current = 0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "defines.h"
+
+// The size of each chunk of scratch memory. Larger requests get a dedicated chunk.
+#define SCRATCH_CHUNK_SIZE (1024 * 1024)
+
+// Every allocation handed out by the scratch allocator is aligned to this many bytes.
+#define SCRATCH_ALIGNMENT 16
+
+// A position in the scratch stack of the calling thread.
+typedef u64 scratch_marker;
+
+/**
+ * Each thread owns a scratch stack for temporary memory. Allocating is a pointer bump;
+ * memory is reclaimed by restoring a marker taken beforehand, so nested helpers can use
+ * it freely:
+ *
+ *   scratch_marker mark = scratch_mark();
+ *   char* buffer = scratch_allocate(4096);
+ *   ...
+ *   scratch_restore(mark);
+ *
+ * Chunks are reserved on first use and kept for reuse, so the platform allocator is only
+ * hit while the stack grows past its previous high-water mark.
+ */
+
+/**
+ * Retrieve the current position of the calling thread's scratch stack.
+ * @return A marker to pass to scratch_restore.
+ */
+AAPI scratch_marker scratch_mark();
+
+/**
+ * Reclaim every scratch allocation made since the marker was taken.
+ * @param marker A marker returned by scratch_mark on the same thread.
+ */
+AAPI void scratch_restore(scratch_marker marker);
+
+/**
+ * Allocate temporary memory from the calling thread's scratch stack. The memory is NOT zeroed.
+ * NOTE: Does not log on failure, since the logger itself relies on the scratch stack.
+ * @param size The number of bytes to allocate.
+ * @return A pointer to the memory, or 0/NULL if the platform is out of memory.
+ */
+AAPI void* scratch_allocate(u64 size);
+
+/**
+ * Release every chunk of the calling thread's scratch stack. Should be called by threads
+ * before they exit.
+ */
+AAPI void scratch_shutdown_thread();
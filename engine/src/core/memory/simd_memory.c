@@ -0,0 +1,147 @@
+#include "simd_memory.h"
+
+#include "platform/platform.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_MEMORY_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#else
+#define SIMD_MEMORY_X86 0
+#endif
+
+typedef void (*PFN_stream_copy)(u8* dest, const u8* source, u64 size);
+
+// The streaming copy picked by simd_memory_initialize. 0 when the CPU has none.
+static PFN_stream_copy stream_copy = 0;
+static const char* path_name = "libc";
+static b8 has_avx2 = FALSE;
+
+#if SIMD_MEMORY_X86
+
+static b8 cpu_has_sse2()
+{
+    u32 eax, ebx, ecx, edx;
+    return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (edx & bit_SSE2);
+}
+
+static b8 cpu_has_avx2()
+{
+    u32 eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_OSXSAVE) || !(ecx & bit_AVX))
+    {
+        return FALSE;
+    }
+
+    // The OS must save the YMM registers on context switches.
+    u32 xcr0_low, xcr0_high;
+    __asm__ volatile("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+    if ((xcr0_low & 0x6) != 0x6)
+    {
+        return FALSE;
+    }
+
+    return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_AVX2);
+}
+
+// The streaming loops write whole aligned vectors, the unaligned head and the tail go through libc.
+
+__attribute__((target("avx2"))) static void stream_copy_avx2(u8* dest, const u8* source, u64 size)
+{
+    u64 head = (32 - ((u64)dest & 31)) & 31;
+    platform_copy_memory(dest, source, head);
+    dest += head;
+    source += head;
+    size -= head;
+
+    for (; size >= 128; size -= 128, dest += 128, source += 128)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i*)source);
+        __m256i b = _mm256_loadu_si256((const __m256i*)(source + 32));
+        __m256i c = _mm256_loadu_si256((const __m256i*)(source + 64));
+        __m256i d = _mm256_loadu_si256((const __m256i*)(source + 96));
+        _mm256_stream_si256((__m256i*)dest, a);
+        _mm256_stream_si256((__m256i*)(dest + 32), b);
+        _mm256_stream_si256((__m256i*)(dest + 64), c);
+        _mm256_stream_si256((__m256i*)(dest + 96), d);
+    }
+    _mm_sfence();
+
+    platform_copy_memory(dest, source, size);
+}
+
+__attribute__((target("sse2"))) static void stream_copy_sse2(u8* dest, const u8* source, u64 size)
+{
+    u64 head = (16 - ((u64)dest & 15)) & 15;
+    platform_copy_memory(dest, source, head);
+    dest += head;
+    source += head;
+    size -= head;
+
+    for (; size >= 64; size -= 64, dest += 64, source += 64)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)source);
+        __m128i b = _mm_loadu_si128((const __m128i*)(source + 16));
+        __m128i c = _mm_loadu_si128((const __m128i*)(source + 32));
+        __m128i d = _mm_loadu_si128((const __m128i*)(source + 48));
+        _mm_stream_si128((__m128i*)dest, a);
+        _mm_stream_si128((__m128i*)(dest + 16), b);
+        _mm_stream_si128((__m128i*)(dest + 32), c);
+        _mm_stream_si128((__m128i*)(dest + 48), d);
+    }
+    _mm_sfence();
+
+    platform_copy_memory(dest, source, size);
+}
+
+#endif
+
+void simd_memory_initialize()
+{
+#if SIMD_MEMORY_X86
+    has_avx2 = cpu_has_avx2();
+    if (has_avx2)
+    {
+        stream_copy = stream_copy_avx2;
+        path_name = "avx2";
+    }
+    else if (cpu_has_sse2())
+    {
+        stream_copy = stream_copy_sse2;
+        path_name = "sse2";
+    }
+#endif
+}
+
+const char* simd_memory_path_name()
+{
+    return path_name;
+}
+
+b8 simd_cpu_has_avx2()
+{
+    return has_avx2;
+}
+
+void* simd_copy_memory(void* dest, const void* source, u64 size)
+{
+    if (size >= SIMD_MEMORY_STREAMING_THRESHOLD && stream_copy)
+    {
+        stream_copy(dest, source, size);
+        return dest;
+    }
+
+    return platform_copy_memory(dest, source, size);
+}
+
+void* simd_stream_memory(void* dest, const void* source, u64 size)
+{
+    // Below a few vectors, the fence costs more than the cache lines saved.
+    if (size >= SIMD_MEMORY_STREAMING_MIN_SIZE && stream_copy)
+    {
+        stream_copy(dest, source, size);
+        return dest;
+    }
+
+    return platform_copy_memory(dest, source, size);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "defines.h"
+
+// Engine-owned memory copies, used by acopy_memory and acopy_memory_streaming.
+// libc is already vectorized and wins for blocks that fit in the cache, so only large
+// copies take the engine's path: non-temporal AVX2 or SSE2 stores that bypass the cache
+// instead of evicting the working set. The path is picked once at startup through CPUID.
+// NOTE: Sets and zeroes stay on libc, it was as fast or faster at every size measured.
+
+// Copies at least this large bypass the cache.
+#define SIMD_MEMORY_STREAMING_THRESHOLD (4 * 1024 * 1024)
+
+// simd_stream_memory falls back to libc below this size.
+#define SIMD_MEMORY_STREAMING_MIN_SIZE (64 * 1024)
+
+// Detect the CPU features and pick the implementation. Called by initialize_memory.
+void simd_memory_initialize();
+
+// Return the name of the streaming path in use: "avx2", "sse2" or "libc".
+AAPI const char* simd_memory_path_name();
+
+// Return TRUE if the CPU and the OS support AVX2, for other kernels picking their path.
+// Valid once simd_memory_initialize has run.
+AAPI b8 simd_cpu_has_avx2();
+
+void* simd_copy_memory(void* dest, const void* source, u64 size);
+
+// Copy with non-temporal stores from SIMD_MEMORY_STREAMING_MIN_SIZE, for data that won't be
+// read back soon such as upload staging and snapshots.
+void* simd_stream_memory(void* dest, const void* source, u64 size);
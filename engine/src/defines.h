@@ -98,4 +98,16 @@ STATIC_ASSERT(sizeof(f64) == 8, "Expected f64 to be 8 bytes.");
 #endif
 #endif
 
+// Thread-local storage and explicit alignment.
+#ifdef _MSC_VER
+#define ATHREAD_LOCAL __declspec(thread)
+#define AALIGN(x) __declspec(align(x))
+#else
+#define ATHREAD_LOCAL __thread
+#define AALIGN(x) __attribute__((aligned(x)))
+#endif
+
+// The size of a cache line on the supported platforms.
+#define ACACHE_LINE_SIZE 64
+
 #define ACLAMP(value, min, max) (value <= min) ? min : (value >= max) ? max : value;
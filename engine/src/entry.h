@@ -3,8 +3,21 @@
 #include "core/application.h"
 #include "core/logger.h"
 #include "core/amemory.h"
+#include "core/memory/scratch_allocator.h"
 #include "game_types.h"
 
+// The total memory budget of the engine, in bytes. 0 means unbounded.
+// Can be defined by the game before including this file.
+#ifndef AMEMORY_BUDGET
+#define AMEMORY_BUDGET 0
+#endif
+
+// How the memory budget is allocated, a combination of memory_large_flags.
+// Add MEMORY_LARGE_PREFAULT to fault the whole budget in at startup rather than mid-frame.
+#ifndef AMEMORY_BUDGET_FLAGS
+#define AMEMORY_BUDGET_FLAGS MEMORY_LARGE_HUGE_PAGES
+#endif
+
 // Externally-defined function to create a game.
 extern b8 create_game(game* out_game);
 
@@ -13,7 +26,11 @@ extern b8 create_game(game* out_game);
 */
 int main(void)
 {
-    initialize_memory();
+    if(!initialize_memory(AMEMORY_BUDGET, AMEMORY_BUDGET_FLAGS))
+    {
+        AFATAL("Failed to initialize the memory subsystem!");
+        return -3;
+    }
 
     // Request the game instance from the application.
     game game_inst;
@@ -46,5 +63,8 @@ int main(void)
 
     shutdown_memory();
 
+    // Last, since shutting down the other systems may still log.
+    scratch_shutdown_thread();
+
     return 0;
 }
@@ -7,6 +7,13 @@ typedef struct platform_state
     void* internal_state;
 } platform_state;
 
+// A block of memory handed out by the platform layer.
+typedef struct platform_memory_block
+{
+    void* block;
+    u64 size;
+} platform_memory_block;
+
 b8 platform_startup(
     platform_state* plat_state,
     const char* application_name,
@@ -20,8 +27,35 @@ b8 platform_pump_message(platform_state* plat_state);
 
 void* platform_allocate(u64 size, b8 aligned);
 void platform_free(void* block, b8 aligned);
+// Resize a block from platform_allocate, in place when possible. Large blocks are remapped
+// rather than copied by most allocators. The grown part is not zeroed.
+void* platform_reallocate(void* block, u64 size);
+// Allocate a zeroed block. Must be freed with platform_free. Large blocks come straight from
+// fresh OS pages, which are already zeroed, so they are not touched.
+void* platform_allocate_zeroed(u64 size);
+// Allocate a block aligned to the given power-of-two alignment. Must be freed with platform_free_aligned.
+void* platform_allocate_aligned(u64 size, u64 alignment);
+void platform_free_aligned(void* block);
+// Virtual memory. Reserving only claims address space; pages must be committed before use and
+// read as zero once committed. Sizes and addresses must be multiples of the page size.
+void* platform_reserve_memory(u64 size);
+b8 platform_commit_memory(void* block, u64 size);
+// Return the pages to the OS. They read as zero if committed again.
+void platform_decommit_memory(void* block, u64 size);
+void platform_release_memory(void* block, u64 size);
+u64 platform_get_page_size();
+// Allocate a large, zeroed block straight from the OS. Must be freed with platform_free_large.
+// huge_pages backs it with huge pages when the OS allows it, falling back to regular pages.
+// prefault faults every page in now rather than on first touch, lock also pins them in RAM.
+void* platform_allocate_large(u64 size, b8 huge_pages, b8 prefault, b8 lock);
+void platform_free_large(void* block, u64 size);
+// Return the number of bytes of blocks allocated with platform_allocate_large that are backed by huge pages.
+// Queries all of them at once, the OS may have to walk the whole address space for each query.
+u64 platform_get_huge_page_bytes(const platform_memory_block* blocks, u32 count);
 void* platform_zero_memory(void* block, u64 size);
 void* platform_copy_memory(void* dest, const void* source, u64 size);
+// Copy between ranges that may overlap.
+void* platform_move_memory(void* dest, const void* source, u64 size);
 void* platform_set_memory(void* dest, i32 value, u64 size);
 
 void platform_console_write(const char* message, u8 color);
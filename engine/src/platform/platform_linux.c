@@ -24,6 +24,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 // For surface createion
 #define VK_USE_PLATFORM_XCB_KHR
@@ -294,6 +296,182 @@ void platform_free(void *block, b8 aligned)
     free(block);
 }
 
+void *platform_reallocate(void *block, u64 size)
+{
+    return realloc(block, size);
+}
+
+void *platform_allocate_zeroed(u64 size)
+{
+    return calloc(1, size);
+}
+
+void *platform_allocate_aligned(u64 size, u64 alignment)
+{
+    // posix_memalign requires at least the alignment of a pointer.
+    if (alignment < sizeof(void *))
+    {
+        alignment = sizeof(void *);
+    }
+
+    void *block = 0;
+    if (posix_memalign(&block, alignment, size) != 0)
+    {
+        return 0;
+    }
+
+    return block;
+}
+
+void platform_free_aligned(void *block)
+{
+    free(block);
+}
+
+void *platform_reserve_memory(u64 size)
+{
+    void *block = mmap(0, size, PROT_NONE, MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0);
+    return block == MAP_FAILED ? 0 : block;
+}
+
+b8 platform_commit_memory(void *block, u64 size)
+{
+    return mprotect(block, size, PROT_READ | PROT_WRITE) == 0;
+}
+
+void platform_decommit_memory(void *block, u64 size)
+{
+    madvise(block, size, MADV_DONTNEED);
+    mprotect(block, size, PROT_NONE);
+}
+
+void platform_release_memory(void *block, u64 size)
+{
+    munmap(block, size);
+}
+
+u64 platform_get_page_size()
+{
+    return (u64)sysconf(_SC_PAGESIZE);
+}
+
+// Transparent huge pages are 2MiB on x86-64 and on arm64 with 4KiB pages.
+#define LINUX_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+static void touch_pages(void *block, u64 size)
+{
+    u64 page_size = platform_get_page_size();
+    for (u64 offset = 0; offset < size; offset += page_size)
+    {
+        ((volatile u8 *)block)[offset] = 0;
+    }
+}
+
+void *platform_allocate_large(u64 size, b8 huge_pages, b8 prefault, b8 lock)
+{
+    size = (size + LINUX_HUGE_PAGE_SIZE - 1) & ~((u64)LINUX_HUGE_PAGE_SIZE - 1);
+
+    void *block = MAP_FAILED;
+    if (huge_pages)
+    {
+        // Explicit huge pages only exist if some were reserved (vm.nr_hugepages).
+        block = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (prefault ? MAP_POPULATE : 0), -1, 0);
+    }
+
+    if (block == MAP_FAILED)
+    {
+        // Over-allocate to align the block on a huge page boundary, transparent huge pages can then back all of it.
+        u64 padded_size = size + LINUX_HUGE_PAGE_SIZE;
+        u8 *raw = mmap(0, padded_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED)
+        {
+            return 0;
+        }
+
+        u8 *aligned = (u8 *)(((u64)raw + LINUX_HUGE_PAGE_SIZE - 1) & ~((u64)LINUX_HUGE_PAGE_SIZE - 1));
+        if (aligned != raw)
+        {
+            munmap(raw, aligned - raw);
+        }
+        munmap(aligned + size, (raw + padded_size) - (aligned + size));
+        block = aligned;
+
+        if (huge_pages)
+        {
+            madvise(block, size, MADV_HUGEPAGE);
+        }
+
+        // Faulting after madvise gets huge pages right away, MAP_POPULATE would fault regular ones.
+        if (prefault || lock)
+        {
+            touch_pages(block, size);
+        }
+    }
+
+    if (lock && mlock(block, size) != 0)
+    {
+        AWARN("platform_allocate_large - Failed to lock %lluB in memory, check RLIMIT_MEMLOCK.", size);
+    }
+
+    return block;
+}
+
+void platform_free_large(void *block, u64 size)
+{
+    size = (size + LINUX_HUGE_PAGE_SIZE - 1) & ~((u64)LINUX_HUGE_PAGE_SIZE - 1);
+    munmap(block, size);
+}
+
+u64 platform_get_huge_page_bytes(const platform_memory_block *blocks, u32 count)
+{
+    FILE *smaps = count ? fopen("/proc/self/smaps", "r") : 0;
+    if (!smaps)
+    {
+        return 0;
+    }
+
+    // Neighbouring blocks with the same flags merge into one mapping, whose counters cover all of
+    // them. Give each block the share of a mapping's huge pages matching the part it covers.
+    u64 block_huge_bytes[count];
+    memset(block_huge_bytes, 0, sizeof(block_huge_bytes));
+    unsigned long long map_begin = 0, map_end = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), smaps))
+    {
+        unsigned long long begin, end, kib;
+        if (sscanf(line, "%llx-%llx ", &begin, &end) == 2)
+        {
+            map_begin = begin;
+            map_end = end;
+        }
+        else if ((sscanf(line, "AnonHugePages: %llu kB", &kib) == 1 ||
+                  sscanf(line, "Private_Hugetlb: %llu kB", &kib) == 1 ||
+                  sscanf(line, "Shared_Hugetlb: %llu kB", &kib) == 1) &&
+                 kib && map_end > map_begin)
+        {
+            for (u32 i = 0; i < count; ++i)
+            {
+                u64 block_begin = (u64)blocks[i].block;
+                u64 block_end = block_begin + blocks[i].size;
+                u64 overlap_begin = block_begin > map_begin ? block_begin : map_begin;
+                u64 overlap_end = block_end < map_end ? block_end : map_end;
+                if (overlap_begin < overlap_end)
+                {
+                    block_huge_bytes[i] += (u64)((f64)kib * 1024 * (overlap_end - overlap_begin) / (map_end - map_begin));
+                }
+            }
+        }
+    }
+    fclose(smaps);
+
+    u64 huge_bytes = 0;
+    for (u32 i = 0; i < count; ++i)
+    {
+        huge_bytes += block_huge_bytes[i] < blocks[i].size ? block_huge_bytes[i] : blocks[i].size;
+    }
+    return huge_bytes;
+}
+
 void *platform_zero_memory(void *block, u64 size)
 {
     return memset(block, 0, size);
@@ -304,6 +482,11 @@ void *platform_copy_memory(void *dest, const void *source, u64 size)
     return memcpy(dest, source, size);
 }
 
+void *platform_move_memory(void *dest, const void *source, u64 size)
+{
+    return memmove(dest, source, size);
+}
+
 void *platform_set_memory(void *dest, i32 value, u64 size)
 {
     return memset(dest, value, size);
@@ -12,6 +12,8 @@
 #include "core/containers/darray.h"
 
 #include <mach/mach_time.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #import <Foundation/Foundation.h>
 #import <Cocoa/Cocoa.h>
@@ -486,6 +488,107 @@ void platform_free(void *block, b8 aligned)
     free(block);
 }
 
+void *platform_reallocate(void *block, u64 size)
+{
+    return realloc(block, size);
+}
+
+void *platform_allocate_zeroed(u64 size)
+{
+    return calloc(1, size);
+}
+
+void *platform_allocate_aligned(u64 size, u64 alignment)
+{
+    // posix_memalign requires at least the alignment of a pointer.
+    if (alignment < sizeof(void *))
+    {
+        alignment = sizeof(void *);
+    }
+
+    void *block = 0;
+    if (posix_memalign(&block, alignment, size) != 0)
+    {
+        return 0;
+    }
+
+    return block;
+}
+
+void platform_free_aligned(void *block)
+{
+    free(block);
+}
+
+void *platform_reserve_memory(u64 size)
+{
+    void *block = mmap(0, size, PROT_NONE, MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0);
+    return block == MAP_FAILED ? 0 : block;
+}
+
+b8 platform_commit_memory(void *block, u64 size)
+{
+    return mprotect(block, size, PROT_READ | PROT_WRITE) == 0;
+}
+
+void platform_decommit_memory(void *block, u64 size)
+{
+    // MADV_DONTNEED is only a hint on macOS, mapping fresh pages over the range drops them for sure.
+    mmap(block, size, PROT_NONE, MAP_FIXED | MAP_PRIVATE | MAP_ANON, -1, 0);
+}
+
+void platform_release_memory(void *block, u64 size)
+{
+    munmap(block, size);
+}
+
+u64 platform_get_page_size()
+{
+    return (u64)sysconf(_SC_PAGESIZE);
+}
+
+static void touch_pages(void *block, u64 size)
+{
+    u64 page_size = platform_get_page_size();
+    for (u64 offset = 0; offset < size; offset += page_size)
+    {
+        ((volatile u8 *)block)[offset] = 0;
+    }
+}
+
+void *platform_allocate_large(u64 size, b8 huge_pages, b8 prefault, b8 lock)
+{
+    // NOTE: Superpages are only available on Intel Macs and would need to be requested at mmap
+    // time, huge_pages is ignored for now.
+    void *block = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    if (block == MAP_FAILED)
+    {
+        return 0;
+    }
+
+    if (prefault || lock)
+    {
+        touch_pages(block, size);
+    }
+
+    if (lock && mlock(block, size) != 0)
+    {
+        AWARN("platform_allocate_large - Failed to lock %lluB in memory.", size);
+    }
+
+    return block;
+}
+
+void platform_free_large(void *block, u64 size)
+{
+    munmap(block, size);
+}
+
+u64 platform_get_huge_page_bytes(const platform_memory_block *blocks, u32 count)
+{
+    return 0;
+}
+
 void *platform_zero_memory(void *block, u64 size)
 {
     return memset(block, 0, size);
@@ -496,6 +599,11 @@ void *platform_copy_memory(void *dest, const void *source, u64 size)
     return memcpy(dest, source, size);
 }
 
+void *platform_move_memory(void *dest, const void *source, u64 size)
+{
+    return memmove(dest, source, size);
+}
+
 void *platform_set_memory(void *dest, i32 value, u64 size)
 {
     return memset(dest, value, size);
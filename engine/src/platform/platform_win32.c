@@ -10,6 +10,8 @@
 #include <windows.h>
 #include <windowsx.h> // Param input extraction
 #include <stdlib.h>
+#include <malloc.h> // _aligned_malloc
+#include <psapi.h>  // QueryWorkingSetEx
 
 #include <vulkan/vulkan.h>
 #include <vulkan/vulkan_win32.h>
@@ -145,6 +147,116 @@ void platform_free(void *block, b8 aligned)
     free(block);
 }
 
+void *platform_reallocate(void *block, u64 size)
+{
+    return realloc(block, size);
+}
+
+void *platform_allocate_zeroed(u64 size)
+{
+    return calloc(1, size);
+}
+
+void *platform_allocate_aligned(u64 size, u64 alignment)
+{
+    return _aligned_malloc(size, alignment);
+}
+
+void platform_free_aligned(void *block)
+{
+    _aligned_free(block);
+}
+
+void *platform_reserve_memory(u64 size)
+{
+    return VirtualAlloc(0, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+b8 platform_commit_memory(void *block, u64 size)
+{
+    return VirtualAlloc(block, size, MEM_COMMIT, PAGE_READWRITE) != 0;
+}
+
+void platform_decommit_memory(void *block, u64 size)
+{
+    VirtualFree(block, size, MEM_DECOMMIT);
+}
+
+void platform_release_memory(void *block, u64 size)
+{
+    VirtualFree(block, 0, MEM_RELEASE);
+}
+
+u64 platform_get_page_size()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+}
+
+void *platform_allocate_large(u64 size, b8 huge_pages, b8 prefault, b8 lock)
+{
+    if (huge_pages)
+    {
+        // Large pages require the SeLockMemoryPrivilege. They are always resident, so
+        // prefaulting and locking come for free.
+        SIZE_T large_page_size = GetLargePageMinimum();
+        if (large_page_size)
+        {
+            u64 large_size = (size + large_page_size - 1) & ~((u64)large_page_size - 1);
+            void *block = VirtualAlloc(0, large_size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (block)
+            {
+                return block;
+            }
+        }
+    }
+
+    void *block = VirtualAlloc(0, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (!block)
+    {
+        return 0;
+    }
+
+    if (prefault || lock)
+    {
+        u64 page_size = platform_get_page_size();
+        for (u64 offset = 0; offset < size; offset += page_size)
+        {
+            ((volatile u8 *)block)[offset] = 0;
+        }
+    }
+
+    if (lock && !VirtualLock(block, size))
+    {
+        AWARN("platform_allocate_large - Failed to lock %lluB in memory, the working set may be too small.", size);
+    }
+
+    return block;
+}
+
+void platform_free_large(void *block, u64 size)
+{
+    VirtualFree(block, 0, MEM_RELEASE);
+}
+
+u64 platform_get_huge_page_bytes(const platform_memory_block *blocks, u32 count)
+{
+    // A block is either entirely made of large pages or not at all.
+    u64 huge_bytes = 0;
+    for (u32 i = 0; i < count; ++i)
+    {
+        PSAPI_WORKING_SET_EX_INFORMATION info;
+        info.VirtualAddress = blocks[i].block;
+        if (QueryWorkingSetEx(GetCurrentProcess(), &info, sizeof(info)) && info.VirtualAttributes.LargePage)
+        {
+            huge_bytes += blocks[i].size;
+        }
+    }
+
+    return huge_bytes;
+}
+
 void *platform_zero_memory(void *block, u64 size)
 {
     return memset(block, 0, size);
@@ -155,6 +267,11 @@ void *platform_copy_memory(void *dest, const void *source, u64 size)
     return memcpy(dest, source, size);
 }
 
+void *platform_move_memory(void *dest, const void *source, u64 size)
+{
+    return memmove(dest, source, size);
+}
+
 void *platform_set_memory(void *dest, i32 value, u64 size)
 {
     return memset(dest, value, size);
@@ -42,8 +42,9 @@ b8 vulkan_renderer_backend_initialize(
     VkInstanceCreateInfo create_info = {VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO};
     create_info.pApplicationInfo = &app_info;
 
-    // Obtain a list of required extensions
-    const char** required_extensions = darray_create(const char*);
+    // Obtain a list of required extensions. A handful at most, kept off the heap.
+    darray_inline_storage(required_extensions_storage, const char*, 4);
+    const char** required_extensions = darray_create_inline(const char*, required_extensions_storage);
     darray_push(required_extensions, &VK_KHR_SURFACE_EXTENSION_NAME);   // Generic surface extension.
     platform_get_required_vulkan_extension_names(&required_extensions); // Platform-specific extension(s).
 #if defined(_DEBUG)
@@ -70,7 +71,8 @@ b8 vulkan_renderer_backend_initialize(
     AINFO("Validation layers enabled. Enumerating...");
 
     // The list of validation layers required.
-    required_validation_layer_names = darray_create(const char*);
+    darray_inline_storage(required_validation_layer_names_storage, const char*, 1);
+    required_validation_layer_names = darray_create_inline(const char*, required_validation_layer_names_storage);
     darray_push(required_validation_layer_names, &"VK_LAYER_KHRONOS_validation");
     required_validation_layer_count = darray_length(required_validation_layer_names);
 
@@ -166,7 +168,10 @@ b8 vulkan_renderer_backend_initialize(
     AINFO("Vulkan renderer initialized successfully.");
 
     darray_destroy(required_extensions);
-    darray_destroy(required_validation_layer_names);
+    if (required_validation_layer_names)
+    {
+        darray_destroy(required_validation_layer_names);
+    }
 
     return TRUE;
 }